@@ -0,0 +1,132 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <Factory.h>
+#include    <GenericEvent.h>
+#include    <Manager.h>
+#include    <Severity.h>
+
+#include    <array>
+#include    <atomic>
+#include    <cstdint>
+
+namespace pentifica::log {
+using CategoryMask = std::uint64_t;
+/// @brief  Base for declaring an event category. Each category is assigned
+///         a distinct bit, e.g.
+///             struct OrderBook : Category<1> {};
+/// @tparam Bit The bit identifying the category (0 is Uncategorized)
+template<unsigned Bit>
+struct Category {
+    static_assert(Bit < 64, "Category bit out of range");
+    static constexpr CategoryMask mask = CategoryMask{1} << Bit;
+};
+/// @brief  The category of events that do not declare one
+struct Uncategorized : Category<0> {};
+/// @brief  Lists the categories used by an application. Fails to compile if
+///         two categories share a bit.
+/// @tparam ...Categories   The declared categories
+template<typename... Categories>
+struct CategoryRegistry {
+    static constexpr CategoryMask all = (CategoryMask{} | ... | Categories::mask);
+    static_assert((CategoryMask{} + ... + Categories::mask) == all, "Categories share a bit");
+};
+/// @brief  The category of an event type. Event types declare a category
+///         with a nested LogCategory type.
+/// @tparam Product The Event derived type
+template<typename Product>
+struct CategoryOf { using type = Uncategorized; };
+
+template<typename Product>
+    requires requires { typename Product::LogCategory; }
+struct CategoryOf<Product> { using type = typename Product::LogCategory; };
+/// @brief  A GenericEvent attached to a category
+/// @tparam Cat         The category of the event
+/// @tparam ...Fields   Parameter pack of fields the event will capture
+template<typename Cat, typename... Fields>
+class CategorizedEvent :
+    public GenericEvent<Fields...>
+{
+public:
+    using LogCategory = Cat;
+    using GenericEvent<Fields...>::GenericEvent;
+};
+/// @brief  Runtime selection of the categories enabled at each Severity.
+///         Checking a category is a single relaxed load, so the check can be
+///         made before an event is created. All categories are enabled at
+///         all severities by default.
+class Categories {
+    static constexpr size_t severity_count = Severity::Fatal + 1;
+
+public:
+    /// @brief This class contains only static methods
+    ~Categories() = delete;
+    /// @brief  Indicates if any of the categories is enabled at a Severity
+    /// @param  mask        The categories to check
+    /// @param  severity    The Severity to check
+    /// @return True if enabled
+    static bool Enabled(CategoryMask mask, Severity severity) noexcept {
+        return (~disabled_[severity].load(std::memory_order_relaxed) & mask) != 0;
+    }
+    /// @brief  Indicates if the category of an event type is enabled
+    /// @tparam Product     The Event derived type
+    /// @param  severity    The Severity to check
+    /// @return True if enabled
+    template<typename Product>
+    static bool Enabled(Severity severity) noexcept {
+        return Enabled(CategoryOf<Product>::type::mask, severity);
+    }
+    /// @brief  Enable the categories at and above the indicated Severity and
+    ///         disable them below it.
+    /// @param  mask        The categories to configure
+    /// @param  threshold   The lowest Severity enabled
+    static void SetThreshold(CategoryMask mask, Severity threshold) noexcept {
+        for(size_t severity = 0; severity < severity_count; ++severity) {
+            if(severity >= threshold) disabled_[severity].fetch_and(~mask, std::memory_order_relaxed);
+            else disabled_[severity].fetch_or(mask, std::memory_order_relaxed);
+        }
+    }
+    /// @brief  Disable the categories at all severities
+    /// @param  mask    The categories to disable
+    static void Disable(CategoryMask mask) noexcept {
+        for(auto& disabled : disabled_) disabled.fetch_or(mask, std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief  The categories disabled at each Severity
+    inline static std::array<std::atomic<CategoryMask>, severity_count> disabled_{};
+};
+/// @brief  Create and enqueue an event only if its category is enabled at
+///         the indicated Severity.
+/// @tparam Product     The Event derived type to create
+/// @tparam ...Ts       The parameter pack definition for the Product ctor
+/// @param  manager     Where to enqueue the event
+/// @param  severity    The severity of the event
+/// @param  ...params   The parameter pack values
+/// @return True if the event was enqueued
+template<typename Product, typename... Ts>
+bool Emit(Manager& manager, Severity severity, Ts&&... params) {
+    if(!Categories::Enabled<Product>(severity)) return false;
+    auto event = Factory<Product>::Create(std::forward<Ts>(params)...);
+    event->Reset(severity);
+    manager.Enqueue(std::move(event));
+    return true;
+}
+}
\ No newline at end of file
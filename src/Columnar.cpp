@@ -0,0 +1,461 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <Columnar.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace pentifica::log {
+namespace {
+    constexpr char columnar_magic[8] = {'P', 'L', 'C', 'O', 'L', 'S', '1', '\0'};
+    /// @brief  Bytes per column in a block directory: min, max, distinct, size
+    constexpr size_t directory_entry = 3 * sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+    template<typename T>
+    void Put(std::string& buffer, T value) {
+        buffer.append(reinterpret_cast<char const*>(&value), sizeof(value));
+    }
+
+    void PutVarint(std::string& buffer, std::uint64_t value) {
+        while(value >= 0x80) {
+            buffer.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    std::uint64_t ZigZag(std::int64_t value) noexcept {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t UnZigZag(std::uint64_t value) noexcept {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    /// @brief  Decodes values from a column payload
+    class Decoder {
+    public:
+        explicit Decoder(std::string_view data) : data_{data} {}
+        template<typename T>
+        T Get() {
+            T value{};
+            if(data_.size() < sizeof(value)) throw std::runtime_error("truncated column");
+            std::memcpy(&value, data_.data(), sizeof(value));
+            data_.remove_prefix(sizeof(value));
+            return value;
+        }
+        std::uint64_t Varint() {
+            std::uint64_t value{};
+            for(int shift = 0; shift < 64; shift += 7) {
+                auto const byte = Get<std::uint8_t>();
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if((byte & 0x80) == 0) return value;
+            }
+            throw std::runtime_error("bad varint");
+        }
+        std::string_view Bytes(size_t size) {
+            if(data_.size() < size) throw std::runtime_error("truncated column");
+            auto const bytes = data_.substr(0, size);
+            data_.remove_prefix(size);
+            return bytes;
+        }
+
+    private:
+        std::string_view data_;
+    };
+
+    /// @brief  A value visited from an event, before it is added to a column
+    struct Cell {
+        ColumnKind kind_{};
+        std::uint64_t bits_{};
+        std::string text_{};
+    };
+
+    /// @brief  Collects the visited fields of an event as cells
+    class RowVisitor :
+        public FieldVisitor
+    {
+    public:
+        explicit RowVisitor(std::vector<Cell>& row) : row_{row} {}
+        void Field(std::int64_t value) override { Next(ColumnKind::Signed).bits_ = std::bit_cast<std::uint64_t>(value); }
+        void Field(std::uint64_t value) override { Next(ColumnKind::Unsigned).bits_ = value; }
+        void Field(double value) override { Next(ColumnKind::Double).bits_ = std::bit_cast<std::uint64_t>(value); }
+        void Field(bool value) override { Next(ColumnKind::Bool).bits_ = value; }
+        void Field(char value) override { Next(ColumnKind::Char).bits_ = static_cast<unsigned char>(value); }
+        void Field(std::string_view value) override { Next(ColumnKind::String).text_.assign(value); }
+        size_t Count() const noexcept { return count_; }
+
+    private:
+        Cell& Next(ColumnKind kind) {
+            if(count_ == row_.size()) row_.emplace_back();
+            auto& cell = row_[count_++];
+            cell.kind_ = kind;
+            return cell;
+        }
+
+        std::vector<Cell>& row_;
+        size_t count_{};
+    };
+
+    /// @brief  Accumulates the values of one column of a block
+    class ColumnBuilder {
+    public:
+        explicit ColumnBuilder(ColumnKind kind) : kind_{kind} {}
+        ColumnKind Kind() const noexcept { return kind_; }
+        void Add(Cell const& cell) {
+            if(kind_ != ColumnKind::String) {
+                bits_.push_back(cell.bits_);
+                return;
+            }
+            auto [entry, added] = dictionary_.try_emplace(cell.text_, static_cast<std::uint32_t>(values_.size()));
+            if(added) values_.push_back(&entry->first);
+            index_.push_back(entry->second);
+        }
+        /// @brief  Encode the values of the block and reset the builder
+        /// @param  payload Receives the encoded values
+        /// @return The statistics of the values
+        ColumnStats Encode(std::string& payload) {
+            ColumnStats stats{kind_};
+            switch(kind_) {
+                case ColumnKind::Signed:    EncodeDeltas<std::int64_t>(payload, stats); break;
+                case ColumnKind::Unsigned:  EncodeDeltas<std::uint64_t>(payload, stats); break;
+                case ColumnKind::Double:
+                    Range<double>(stats);
+                    for(auto bits : bits_) Put(payload, bits);
+                    break;
+                case ColumnKind::Bool:
+                case ColumnKind::Char:
+                    Range<std::uint64_t>(stats);
+                    for(auto bits : bits_) payload.push_back(static_cast<char>(bits));
+                    break;
+                case ColumnKind::String:
+                    stats.distinct_ = values_.size();
+                    PutVarint(payload, values_.size());
+                    for(auto value : values_) {
+                        PutVarint(payload, value->size());
+                        payload.append(*value);
+                    }
+                    for(auto index : index_) PutVarint(payload, index);
+                    break;
+            }
+            bits_.clear();
+            dictionary_.clear();
+            values_.clear();
+            index_.clear();
+            return stats;
+        }
+
+    private:
+        template<typename T>
+        void Range(ColumnStats& stats) const {
+            if(bits_.empty()) return;
+            auto [min, max] = std::minmax_element(bits_.begin(), bits_.end(), [](auto a, auto b) {
+                return std::bit_cast<T>(a) < std::bit_cast<T>(b);
+            });
+            stats.min_ = *min;
+            stats.max_ = *max;
+        }
+        template<typename T>
+        void EncodeDeltas(std::string& payload, ColumnStats& stats) const {
+            Range<T>(stats);
+            std::uint64_t previous{};
+            for(auto bits : bits_) {
+                PutVarint(payload, ZigZag(static_cast<std::int64_t>(bits - previous)));
+                previous = bits;
+            }
+        }
+
+        ColumnKind const kind_;
+        std::vector<std::uint64_t> bits_;
+        std::unordered_map<std::string, std::uint32_t> dictionary_;
+        std::vector<std::string const*> values_;
+        std::vector<std::uint32_t> index_;
+    };
+}
+
+/// @brief  The cells of the event being appended
+class ColumnarSink::Row {
+public:
+    std::vector<Cell> cells_;
+};
+
+/// @brief  The file, and the block being built, of one event type
+class ColumnarSink::Table {
+public:
+    Table(std::string const& path, std::string_view type_name, std::vector<Cell> const& row, size_t fields) :
+        file_{path, std::ios::binary | std::ios::trunc}
+    {
+        std::string header{columnar_magic, sizeof(columnar_magic)};
+        Put(header, static_cast<std::uint16_t>(type_name.size()));
+        header.append(type_name);
+        Put(header, static_cast<std::uint16_t>(fields + 2));
+
+        auto column = [&header, this](ColumnKind kind, std::string_view name) {
+            columns_.emplace_back(kind);
+            header.push_back(static_cast<char>(kind));
+            Put(header, static_cast<std::uint16_t>(name.size()));
+            header.append(name);
+        };
+        column(ColumnKind::Signed, "time");
+        column(ColumnKind::Unsigned, "severity");
+        for(size_t i = 0; i < fields; ++i) column(row[i].kind_, "field" + std::to_string(i));
+        file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+        file_.flush();
+    }
+    /// @brief  Indicates if the visited fields match the columns
+    bool Matches(std::vector<Cell> const& row, size_t fields) const {
+        if(fields + 2 != columns_.size()) return false;
+        for(size_t i = 0; i < fields; ++i) {
+            if(row[i].kind_ != columns_[i + 2].Kind()) return false;
+        }
+        return true;
+    }
+    void Append(Event const& event, std::vector<Cell> const& row, size_t fields) {
+        if(rows_ == 0) started_ = std::chrono::steady_clock::now();
+        auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(event.GetTime().time_since_epoch());
+        columns_[0].Add(Cell{ColumnKind::Signed, std::bit_cast<std::uint64_t>(static_cast<std::int64_t>(time.count()))});
+        columns_[1].Add(Cell{ColumnKind::Unsigned, static_cast<std::uint64_t>(event.GetSeverity())});
+        for(size_t i = 0; i < fields; ++i) columns_[i + 2].Add(row[i]);
+        ++rows_;
+    }
+    size_t Rows() const noexcept { return rows_; }
+    /// @brief  When the first row of the block was appended
+    std::chrono::steady_clock::time_point Started() const noexcept { return started_; }
+    /// @brief  Indicates if the file can still be written
+    bool Good() const noexcept { return static_cast<bool>(file_); }
+    /// @brief  Write the block: the row count, the directory of column
+    ///         statistics and sizes, then the column payloads
+    /// @return The number of rows that could not be written
+    size_t WriteBlock() {
+        if(rows_ == 0) return 0;
+
+        std::string directory;
+        std::string payloads;
+        Put(directory, static_cast<std::uint32_t>(rows_));
+        for(auto& column : columns_) {
+            auto const start = payloads.size();
+            auto const stats = column.Encode(payloads);
+            Put(directory, stats.min_);
+            Put(directory, stats.max_);
+            Put(directory, stats.distinct_);
+            Put(directory, static_cast<std::uint32_t>(payloads.size() - start));
+        }
+        file_.write(directory.data(), static_cast<std::streamsize>(directory.size()));
+        file_.write(payloads.data(), static_cast<std::streamsize>(payloads.size()));
+        file_.flush();
+        auto const rows = std::exchange(rows_, 0);
+        return Good() ? 0 : rows;
+    }
+
+private:
+    std::ofstream file_;
+    std::vector<ColumnBuilder> columns_;
+    size_t rows_{};
+    std::chrono::steady_clock::time_point started_{};
+};
+
+ColumnarSink::ColumnarSink(std::string directory, size_t block_rows, std::chrono::milliseconds max_age) :
+    directory_{std::move(directory)},
+    block_rows_{std::max<size_t>(block_rows, 1)},
+    max_age_{max_age},
+    row_{std::make_unique<Row>()}
+{
+}
+
+ColumnarSink::~ColumnarSink() {
+    Flush();
+}
+
+std::string
+ColumnarSink::Path(std::type_info const& type) const {
+    std::string name{type.name()};
+    for(auto& c : name) {
+        if(!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+    }
+    // Keep within file name limits, keeping the names of distinct types distinct
+    if(name.size() > 200) {
+        auto const hash = std::hash<std::string_view>{}(type.name());
+        name.resize(180);
+        name += '_' + std::to_string(hash);
+    }
+    return directory_ + '/' + name + ".col";
+}
+
+void
+ColumnarSink::Append(Event const& event) {
+    auto const& row = row_->cells_;
+    RowVisitor visitor{row_->cells_};
+    event.Visit(visitor);
+    auto const fields = visitor.Count();
+
+    auto found = tables_.find(std::type_index(typeid(event)));
+    if(found == tables_.end()) {
+        // Only a table whose file was created is kept; the next event of
+        // the type tries again
+        auto table = std::make_unique<Table>(Path(typeid(event)), typeid(event).name(), row, fields);
+        if(!table->Good()) {
+            ++failed_;
+            return;
+        }
+        found = tables_.emplace(std::type_index(typeid(event)), std::move(table)).first;
+    }
+    auto& table = *found->second;
+    if(!table.Matches(row, fields)) {
+        ++rejected_;
+        return;
+    }
+
+    table.Append(event, row, fields);
+    ++appended_;
+    if(table.Rows() == block_rows_) failed_ += table.WriteBlock();
+}
+
+void
+ColumnarSink::Flush() {
+    for(auto& [type, table] : tables_) failed_ += table->WriteBlock();
+}
+
+void
+ColumnarSink::FlushExpired() {
+    auto const now = std::chrono::steady_clock::now();
+    for(auto& [type, table] : tables_) {
+        if(table->Rows() > 0 && now - table->Started() >= max_age_) failed_ += table->WriteBlock();
+    }
+}
+
+ColumnarReader::ColumnarReader(std::string const& path) :
+    file_{path, std::ios::binary}
+{
+    auto read = [this](void* data, size_t size) {
+        if(!file_.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("not a columnar file");
+        }
+    };
+    auto read_string = [&read](std::string& text) {
+        std::uint16_t size{};
+        read(&size, sizeof(size));
+        text.resize(size);
+        read(text.data(), size);
+    };
+
+    char magic[sizeof(columnar_magic)]{};
+    read(magic, sizeof(magic));
+    if(std::memcmp(magic, columnar_magic, sizeof(magic)) != 0) throw std::runtime_error("not a columnar file: " + path);
+
+    read_string(type_name_);
+    std::uint16_t count{};
+    read(&count, sizeof(count));
+    columns_.resize(count);
+    for(auto& column : columns_) {
+        std::uint8_t kind{};
+        read(&kind, sizeof(kind));
+        column.kind_ = static_cast<ColumnKind>(kind);
+        read_string(column.name_);
+    }
+    next_block_ = static_cast<std::uint64_t>(file_.tellg());
+}
+
+size_t
+ColumnarReader::Find(std::string_view name) const {
+    for(size_t i = 0; i < columns_.size(); ++i) {
+        if(columns_[i].name_ == name) return i;
+    }
+    throw std::out_of_range("no column " + std::string(name));
+}
+
+bool
+ColumnarReader::NextBlock() {
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(next_block_));
+
+    std::string directory(sizeof(std::uint32_t) + columns_.size() * directory_entry, '\0');
+    if(!file_.read(directory.data(), static_cast<std::streamsize>(directory.size()))) return false;
+
+    Decoder decoder{directory};
+    rows_ = decoder.Get<std::uint32_t>();
+    auto offset = next_block_ + directory.size();
+    for(auto& column : columns_) {
+        column.stats_.kind_ = column.kind_;
+        column.stats_.min_ = decoder.Get<std::uint64_t>();
+        column.stats_.max_ = decoder.Get<std::uint64_t>();
+        column.stats_.distinct_ = decoder.Get<std::uint64_t>();
+        column.size_ = decoder.Get<std::uint32_t>();
+        column.offset_ = offset;
+        offset += column.size_;
+    }
+    next_block_ = offset;
+    return true;
+}
+
+Column
+ColumnarReader::Read(size_t index) {
+    auto const& info = columns_.at(index);
+    std::string payload(info.size_, '\0');
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(info.offset_));
+    if(!file_.read(payload.data(), static_cast<std::streamsize>(payload.size()))) {
+        throw std::runtime_error("truncated columnar file");
+    }
+
+    Column column{info.kind_};
+    Decoder decoder{payload};
+    std::uint64_t previous{};
+    switch(info.kind_) {
+        case ColumnKind::Signed:
+            column.signed_.reserve(rows_);
+            for(size_t row = 0; row < rows_; ++row) {
+                previous += static_cast<std::uint64_t>(UnZigZag(decoder.Varint()));
+                column.signed_.push_back(static_cast<std::int64_t>(previous));
+            }
+            break;
+        case ColumnKind::Unsigned:
+            column.unsigned_.reserve(rows_);
+            for(size_t row = 0; row < rows_; ++row) {
+                previous += static_cast<std::uint64_t>(UnZigZag(decoder.Varint()));
+                column.unsigned_.push_back(previous);
+            }
+            break;
+        case ColumnKind::Double:
+            column.double_.reserve(rows_);
+            for(size_t row = 0; row < rows_; ++row) column.double_.push_back(decoder.Get<double>());
+            break;
+        case ColumnKind::Bool:
+        case ColumnKind::Char: {
+            auto const bytes = decoder.Bytes(rows_);
+            column.byte_.assign(bytes.begin(), bytes.end());
+            break;
+        }
+        case ColumnKind::String: {
+            column.dictionary_.resize(decoder.Varint());
+            for(auto& value : column.dictionary_) value = decoder.Bytes(decoder.Varint());
+            column.index_.reserve(rows_);
+            for(size_t row = 0; row < rows_; ++row) column.index_.push_back(static_cast<std::uint32_t>(decoder.Varint()));
+            break;
+        }
+    }
+    return column;
+}
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include <Event.h>
+#include <Utility.h>
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace pentifica::log {
+/// @brief  How the values of a column are stored
+enum class ColumnKind : std::uint8_t {
+    /// @brief  Delta encoded, zig-zag varints
+    Signed,
+    /// @brief  Delta encoded, zig-zag varints
+    Unsigned,
+    /// @brief  8 bytes per value
+    Double,
+    /// @brief  1 byte per value
+    Bool,
+    /// @brief  1 byte per value
+    Char,
+    /// @brief  A dictionary of the distinct values of the block, followed by
+    ///         a varint dictionary index per value
+    String,
+};
+
+/// @brief  Statistics of one column of one block, used to skip blocks
+///         without decoding them
+struct ColumnStats {
+    ColumnKind kind_{};
+    /// @brief  The bit patterns of the min and max values (see Min, Max).
+    ///         Not set for String columns.
+    std::uint64_t min_{};
+    std::uint64_t max_{};
+    /// @brief  The number of distinct values; only set for String columns
+    std::uint64_t distinct_{};
+    /// @brief  The min value of the block as the column type, e.g.
+    ///         Min<double>() for a Double column
+    template<typename T>
+    T Min() const noexcept { return std::bit_cast<T>(min_); }
+    /// @brief  The max value of the block as the column type
+    template<typename T>
+    T Max() const noexcept { return std::bit_cast<T>(max_); }
+};
+
+/// @brief  The decoded values of one column of one block. Only the members
+///         for the column's kind are filled.
+struct Column {
+    ColumnKind kind_{};
+    std::vector<std::int64_t> signed_{};
+    std::vector<std::uint64_t> unsigned_{};
+    std::vector<double> double_{};
+    /// @brief  Bool and Char values
+    std::vector<char> byte_{};
+    /// @brief  String columns: the distinct values of the block
+    std::vector<std::string> dictionary_{};
+    /// @brief  String columns: the dictionary index of each value
+    std::vector<std::uint32_t> index_{};
+};
+
+/// @brief  Writes each event type to its own columnar file, instead of a
+///         line of text per event (see Manager::SetColumnar). A file has a
+///         time and a severity column, then one column per field (see
+///         Event::Visit), and is written in blocks of rows. Each block
+///         starts with a directory of per-column statistics and sizes, so a
+///         ColumnarReader decodes only the columns, and blocks, it needs.
+///         Not thread safe; events are appended by the flushing thread.
+///         I/O errors are not thrown; events that could not be written are
+///         counted (see Failed).
+class ColumnarSink {
+public:
+    /// @brief  Prepare a sink; files are created as event types are seen
+    /// @param  directory   Where the files are written; must exist
+    /// @param  block_rows  The number of rows in a full block
+    /// @param  max_age     A partial block is written by FlushExpired once
+    ///                     its first row is this old
+    explicit ColumnarSink(std::string directory,
+                          size_t block_rows = 4096,
+                          std::chrono::milliseconds max_age = std::chrono::seconds(1));
+    /// @brief Deleted
+    ColumnarSink(ColumnarSink const&) = delete;
+    /// @brief  Writes the partial blocks
+    ~ColumnarSink();
+    /// @brief Deleted
+    ColumnarSink& operator=(ColumnarSink const&) = delete;
+    /// @brief  Append an event to the file of its type. Events of a type
+    ///         whose fields do not match the columns of its file are
+    ///         rejected.
+    /// @param  event   The event to append
+    void Append(Event const& event);
+    /// @brief  Write the partial blocks, so every appended event is on disk
+    void Flush();
+    /// @brief  Write the partial blocks that have reached the maximum age.
+    ///         Called on every flush of the Manager, so events of a slow
+    ///         type reach the disk without writing a small block per flush.
+    void FlushExpired();
+    /// @brief  The path of the file for an event type
+    /// @param  type    The event type
+    std::string Path(std::type_info const& type) const;
+    /// @brief  The number of events appended
+    size_t Appended() const noexcept { return appended_; }
+    /// @brief  The number of events rejected
+    size_t Rejected() const noexcept { return rejected_; }
+    /// @brief  The number of events that could not be written, because
+    ///         the file of their type could not be created or written
+    size_t Failed() const noexcept { return failed_; }
+
+private:
+    class Table;
+    class Row;
+
+    std::string const directory_;
+    size_t const block_rows_;
+    std::chrono::milliseconds const max_age_;
+    std::unordered_map<std::type_index, std::unique_ptr<Table>> tables_;
+    /// @brief  The visited fields of the event being appended, reused
+    std::unique_ptr<Row> row_;
+    size_t appended_{};
+    size_t rejected_{};
+    size_t failed_{};
+};
+
+/// @brief  Reads a file written by a ColumnarSink one block at a time,
+///         decoding only the requested columns, e.g.
+///             ColumnarReader reader{path};
+///             auto const price = reader.Find("field3");
+///             while(reader.NextBlock()) {
+///                 if(reader.Stats(price).Max<double>() < 100) continue;
+///                 auto const column = reader.Read(price);
+///                 ...
+///             }
+class ColumnarReader {
+public:
+    /// @brief  Open a file and read its columns
+    /// @param  path    The file
+    /// @throws std::runtime_error if the file was not written by a
+    ///         ColumnarSink
+    explicit ColumnarReader(std::string const& path);
+    /// @brief  The name of the event type, as reported by typeid
+    std::string const& TypeName() const noexcept { return type_name_; }
+    /// @brief  The number of columns
+    size_t ColumnCount() const noexcept { return columns_.size(); }
+    /// @brief  The name of a column: time, severity, field0, field1, ...
+    std::string const& ColumnName(size_t column) const { return columns_.at(column).name_; }
+    ColumnKind Kind(size_t column) const { return columns_.at(column).kind_; }
+    /// @brief  The index of the named column
+    /// @throws std::out_of_range if there is no such column
+    size_t Find(std::string_view name) const;
+    /// @brief  Advance to the next block, reading only its directory
+    /// @return False if there are no more blocks
+    bool NextBlock();
+    /// @brief  The number of rows in the current block
+    size_t Rows() const noexcept { return rows_; }
+    /// @brief  The statistics of a column of the current block
+    ColumnStats const& Stats(size_t column) const { return columns_.at(column).stats_; }
+    /// @brief  Decode a column of the current block
+    /// @param  column  The index of the column
+    Column Read(size_t column);
+
+private:
+    struct Info {
+        std::string name_;
+        ColumnKind kind_;
+        ColumnStats stats_;
+        std::uint64_t offset_;
+        std::uint32_t size_;
+    };
+
+    std::ifstream file_;
+    std::string type_name_;
+    std::vector<Info> columns_;
+    size_t rows_{};
+    std::uint64_t next_block_{};
+};
+}
\ No newline at end of file
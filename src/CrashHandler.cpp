@@ -0,0 +1,105 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <CrashHandler.h>
+#include <Utility.h>
+
+#include <array>
+#include <atomic>
+#include <csignal>
+
+#include <signal.h>
+#include <unistd.h>
+
+namespace pentifica::log {
+namespace {
+    constexpr std::array fatal_signals {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+    std::atomic<int> dump_fd{-1};
+    std::array<std::atomic<Manager*>, CrashHandler::max_managers> managers{};
+    /// @brief  Set by the first thread to crash; later crashes do not dump
+    std::atomic_flag dumping = ATOMIC_FLAG_INIT;
+    /// @brief  Alternate stack so the handler can run after a stack overflow
+    ///         of the thread that installed the handler
+    alignas(16) char alternate_stack[64 * 1024];
+
+    void WriteAll(int fd, std::string_view text) noexcept {
+        while(!text.empty()) {
+            auto const written = ::write(fd, text.data(), text.size());
+            if(written <= 0) return;
+            text.remove_prefix(static_cast<size_t>(written));
+        }
+    }
+
+    void OnFatalSignal(int signal) {
+        auto const fd = dump_fd.load(std::memory_order_relaxed);
+        if(fd >= 0 && !dumping.test_and_set()) {
+            char header[64];
+            SnapshotWriter writer{header, sizeof(header)};
+            writer.Write("*** fatal signal ").Write(signal).Write(", pending events:\n");
+            WriteAll(fd, writer.View());
+            for(auto const& entry : managers) {
+                if(auto manager = entry.load(std::memory_order_acquire)) manager->CrashDump(fd);
+            }
+        }
+        // SA_RESETHAND restored the default action
+        raise(signal);
+    }
+}
+
+bool
+CrashHandler::Install(int fd) {
+    dump_fd.store(fd, std::memory_order_relaxed);
+
+    stack_t stack{};
+    stack.ss_sp = alternate_stack;
+    stack.ss_size = sizeof(alternate_stack);
+    bool installed = sigaltstack(&stack, nullptr) == 0;
+
+    struct sigaction action{};
+    action.sa_handler = &OnFatalSignal;
+    action.sa_flags = SA_RESETHAND | SA_ONSTACK | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    for(auto signal : fatal_signals) {
+        installed &= sigaction(signal, &action, nullptr) == 0;
+    }
+    return installed;
+}
+
+bool
+CrashHandler::Register(Manager& manager) noexcept {
+    for(auto const& entry : managers) {
+        if(entry.load(std::memory_order_relaxed) == &manager) return true;
+    }
+    for(auto& entry : managers) {
+        Manager* expected{};
+        if(entry.compare_exchange_strong(expected, &manager, std::memory_order_release)) return true;
+    }
+    return false;
+}
+
+void
+CrashHandler::Unregister(Manager& manager) noexcept {
+    for(auto& entry : managers) {
+        Manager* expected{&manager};
+        entry.compare_exchange_strong(expected, nullptr, std::memory_order_release);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include <Manager.h>
+
+namespace pentifica::log {
+/// @brief  Writes the pending events of registered managers when the process
+///         receives a fatal signal (SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT).
+///         The handler uses only async-signal-safe operations: events are
+///         rendered with Event::Snapshot and written with write(2) to a
+///         descriptor opened in advance. After the dump, the default action
+///         of the signal is restored and the signal is raised again.
+class CrashHandler {
+public:
+    /// @brief  The max number of managers that can be registered
+    static constexpr size_t max_managers = 16;
+    /// @brief This class contains only static methods
+    ~CrashHandler() = delete;
+    /// @brief  Install the fatal signal handlers
+    /// @param  fd  Where to write pending events; must remain open
+    /// @return False if a handler could not be installed
+    static bool Install(int fd);
+    /// @brief  Add a manager whose pending events are written on a crash.
+    ///         A manager already registered is not added again.
+    /// @param  manager The manager to add; must be unregistered before it
+    ///                 is destroyed
+    /// @return False if the max number of managers are registered
+    static bool Register(Manager& manager) noexcept;
+    /// @brief  Remove a manager
+    /// @param  manager The manager to remove
+    static void Unregister(Manager& manager) noexcept;
+};
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <DatagramSink.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace pentifica::log {
+DatagramSink::DatagramSink(std::string path, size_t max_pending, size_t batch, size_t frame_size) :
+    path_{std::move(path)},
+    frame_size_{std::max<size_t>(frame_size, 1)},
+    capacity_{std::max<size_t>(max_pending / frame_size_, 1)},
+    batch_{std::clamp<size_t>(batch, 1, capacity_)},
+    frames_((capacity_ + 1) * frame_size_),
+    lengths_(capacity_ + 1),
+    records_(batch_),
+    messages_(batch_)
+{
+}
+
+DatagramSink::~DatagramSink() {
+    Send();
+    Disconnect();
+}
+
+DatagramSink::int_type
+DatagramSink::overflow(int_type c) {
+    if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    auto const character = traits_type::to_char_type(c);
+    if(character == '\n') EndRecord();
+    else Append(&character, 1);
+    return c;
+}
+
+std::streamsize
+DatagramSink::xsputn(char const* text, std::streamsize count) {
+    auto next = text;
+    auto const end = text + count;
+    while(next != end) {
+        auto const newline = static_cast<char const*>(std::memchr(next, '\n', static_cast<size_t>(end - next)));
+        if(newline == nullptr) {
+            Append(next, static_cast<size_t>(end - next));
+            break;
+        }
+        Append(next, static_cast<size_t>(newline - next));
+        EndRecord();
+        next = newline + 1;
+    }
+    return count;
+}
+
+int
+DatagramSink::sync() {
+    Send();
+    return 0;
+}
+
+void
+DatagramSink::Append(char const* text, size_t size) {
+    if(oversized_) return;
+    if(record_ + size > frame_size_) {
+        oversized_ = true;
+        return;
+    }
+    auto const tail = (head_ + count_) % lengths_.size();
+    std::memcpy(frames_.data() + tail * frame_size_ + record_, text, size);
+    record_ += size;
+}
+
+void
+DatagramSink::EndRecord() {
+    if(oversized_) ++dropped_;
+    else {
+        lengths_[(head_ + count_) % lengths_.size()] = record_;
+        ++count_;
+    }
+    record_ = 0;
+    oversized_ = false;
+
+    if(count_ > capacity_) {
+        PopFront();
+        ++dropped_;
+    }
+    if(count_ >= batch_) Send();
+}
+
+void
+DatagramSink::PopFront() {
+    head_ = (head_ + 1) % lengths_.size();
+    --count_;
+}
+
+bool
+DatagramSink::Connect() {
+    if(fd_ >= 0) return true;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(path_.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd_ < 0) return false;
+    if(::connect(fd_, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+        Disconnect();
+        return false;
+    }
+    return true;
+}
+
+void
+DatagramSink::Disconnect() {
+    if(fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+void
+DatagramSink::Send() {
+    while(count_ != 0 && Connect()) {
+        auto const count = std::min(count_, batch_);
+        for(size_t i = 0; i < count; ++i) {
+            auto const frame = (head_ + i) % lengths_.size();
+            records_[i] = iovec{frames_.data() + frame * frame_size_, lengths_[frame]};
+            messages_[i] = mmsghdr{};
+            messages_[i].msg_hdr.msg_iov = &records_[i];
+            messages_[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        auto const sent = ::sendmmsg(fd_, messages_.data(), static_cast<unsigned>(count), 0);
+        if(sent > 0) {
+            for(int i = 0; i < sent; ++i) PopFront();
+            sent_ += static_cast<size_t>(sent);
+            continue;
+        }
+
+        if(errno == EINTR) continue;
+        if(errno == EMSGSIZE) {
+            // The first record can never be sent as a datagram
+            PopFront();
+            ++dropped_;
+            continue;
+        }
+        // The collector is slow; retry on the next flush
+        if(errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) return;
+        // The collector has gone; reconnect on the next flush
+        Disconnect();
+        return;
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <streambuf>
+#include    <string>
+#include    <vector>
+
+#include    <sys/socket.h>
+
+namespace pentifica::log {
+/// @brief  Stream buffer sending each line written to it as one datagram
+///         over a Unix domain socket to a local collector, e.g.
+///             DatagramSink sink{"/run/log/collector.sock"};
+///             std::ostream os{&sink};
+///             Manager manager{os, capacity};
+///         Completed lines are held until a batch is full or the stream is
+///         flushed, then sent with sendmmsg, many records per system call.
+///         The socket is (re)connected on demand, so the collector may start
+///         late or restart. Records are written straight into a ring of
+///         fixed size frames allocated up front, so the send path does not
+///         allocate. If the collector is slow or absent, the ring fills and
+///         the oldest records are dropped.
+class DatagramSink :
+    public std::streambuf
+{
+public:
+    /// @brief  Prepare a sink; no connection is attempted until records are
+    ///         sent
+    /// @param  path        The path of the collector's socket
+    /// @param  max_pending The max number of bytes of records held while the
+    ///                     collector is slow or absent; at least one frame
+    /// @param  batch       The max number of records sent per system call
+    /// @param  frame_size  The max length of a record; longer records are
+    ///                     dropped
+    explicit DatagramSink(std::string path, size_t max_pending = 1024 * 1024, size_t batch = 64, size_t frame_size = 4096);
+    /// @brief Deleted
+    DatagramSink(DatagramSink const&) = delete;
+    /// @brief Deleted
+    DatagramSink(DatagramSink&&) = delete;
+    /// @brief  Attempts to send the held records and closes the socket
+    ~DatagramSink() override;
+    /// @brief Deleted
+    DatagramSink& operator=(DatagramSink const&) = delete;
+    /// @brief Deleted
+    DatagramSink& operator=(DatagramSink&&) = delete;
+    /// @brief  Indicates if the sink is connected to the collector
+    bool Connected() const noexcept { return fd_ >= 0; }
+    /// @brief  The number of records sent to the collector
+    size_t Sent() const noexcept { return sent_; }
+    /// @brief  The number of records dropped, because the ring was full or
+    ///         the record was too large for a frame or a datagram
+    size_t Dropped() const noexcept { return dropped_; }
+    /// @brief  The number of completed records not yet sent
+    size_t Pending() const noexcept { return count_; }
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(char const* text, std::streamsize count) override;
+    /// @brief  Send the held records
+    int sync() override;
+
+private:
+    /// @brief  Append text to the current record's frame
+    void Append(char const* text, size_t size);
+    /// @brief  Hold the current record for sending
+    void EndRecord();
+    /// @brief  Release the oldest held record
+    void PopFront();
+    /// @brief  Send held records while the collector accepts them
+    void Send();
+    /// @brief  Connect to the collector
+    /// @return True if connected
+    bool Connect();
+    void Disconnect();
+
+    std::string const path_;
+    size_t const frame_size_;
+    size_t const capacity_;         ///< Max number of held records
+    size_t const batch_;
+    int fd_{-1};
+    //  capacity_ + 1 frames, so the current record always has a free frame
+    std::vector<char> frames_;
+    std::vector<size_t> lengths_;
+    size_t head_{};                 ///< The frame of the oldest held record
+    size_t count_{};                ///< The number of held records
+    size_t record_{};               ///< The length of the current record
+    bool oversized_{};              ///< The current record exceeds its frame
+    std::vector<iovec> records_;
+    std::vector<mmsghdr> messages_;
+    size_t sent_{};
+    size_t dropped_{};
+};
+}
\ No newline at end of file
@@ -28,6 +28,26 @@ namespace pentifica::log { class Event; }
 std::ostream& operator<<(std::ostream&, pentifica::log::Event const&);
 
 namespace pentifica::log {
+/// @brief  Keep the Event stream operator visible within the namespace, where
+///         other operator<< overloads would otherwise hide it.
+using ::operator<<;
+
+class SnapshotWriter;
+class Metrics;
+class FieldVisitor;
+/// @brief  Streams an Event as a single line JSON object, e.g.
+///             os << AsJson{event};
+struct AsJson {
+    Event const& event_;
+    /// @brief  Stream the Event as a JSON line
+    /// @param  os  Where to stream the Event
+    void Write(std::ostream& os) const;
+    friend std::ostream& operator<<(std::ostream& os, AsJson const& json) {
+        json.Write(os);
+        return os;
+    }
+};
+
 /// @brief  Represents the common information all logging events will
 ///         capture.
 class Event {
@@ -51,6 +71,38 @@ public:
     /// @brief  Reset the Event time
     /// @param time The Event time update
     void Reset(TimePoint time) { time_ = time; }
+    /// @brief  The Severity associated with the Event
+    /// @return The Event Severity
+    Severity GetSeverity() const noexcept { return severity_; }
+    /// @brief  The Event time
+    /// @return The Event time
+    TimePoint GetTime() const noexcept { return time_; }
+    /// @brief  Indicates if the indicated Event carries the same information
+    ///         as this Event, ignoring Severity and time. Used to coalesce
+    ///         repeated events. By default, no two events are equivalent.
+    /// @param  other   The Event to compare against
+    /// @return True if the events carry the same information
+    virtual bool Equivalent(Event const&) const { return false; }
+    /// @brief  The memory used by the Event, including memory owned by its
+    ///         members. Used to enforce a Manager memory budget.
+    /// @return The number of bytes used by the Event
+    virtual size_t Footprint() const noexcept { return sizeof(Event); }
+    /// @brief  Fold the Event into the aggregates of its type instead of
+    ///         queuing it, when the Manager aggregates metrics. By default
+    ///         events are not aggregated, and the calling thread's shard of
+    ///         the aggregates is not looked up.
+    /// @param  metrics The aggregates of the Manager
+    /// @return True if the Event was aggregated
+    virtual bool Fold(Metrics&) const { return false; }
+    /// @brief  Pass each field of the Event to the visitor, in order. By
+    ///         default the output of Log is passed as a single string field.
+    /// @param  visitor Receives the fields
+    virtual void Visit(FieldVisitor& visitor) const;
+    /// @brief  Render the Event state using only async-signal-safe
+    ///         operations, for use by a crash handler. By default the type
+    ///         name of the Event is rendered.
+    /// @param  writer  Where to render the Event state
+    virtual void Snapshot(SnapshotWriter& writer) const noexcept;
     Event& operator=(Event const&) = default;
     Event& operator=(Event&&) = default;
     /// @brief  Stream the Event information to the indicated stream
@@ -58,11 +110,17 @@ public:
     /// @param  event   The Event to stream
     /// @return The supplied stream
     friend std::ostream& ::operator<<(std::ostream& os, Event const& event);
+    friend struct AsJson;
 
 protected:
     /// @brief  Support for streaming derived classes
     /// @param  os  Where to stream derived state
     virtual void Log(std::ostream& os) const = 0;
+    /// @brief  Support for streaming derived classes as JSON. Writes the
+    ///         members of the derived state, each preceded by a comma. By
+    ///         default the output of Log is written as an escaped "message".
+    /// @param  os  Where to stream derived state
+    virtual void LogJson(std::ostream& os) const;
 
 private:
     Severity severity_ {Severity::Debug};
@@ -72,4 +130,11 @@ private:
 using EventDel = void(*)(Event*);
 
 using EventRef = std::unique_ptr<Event, EventDel>;
+
+/// @brief  Streams a time as local time with microsecond resolution,
+///         e.g. 2023-01-14 13:47:29.004389
+/// @param  os      Where to stream the time
+/// @param  time    The time to stream
+/// @return The supplied stream
+std::ostream& StreamTime(std::ostream& os, Event::TimePoint time);
 }
\ No newline at end of file
@@ -26,15 +26,48 @@
 #include    <ranges>
 #include    <type_traits>
 #include    <mutex>
+#include    <cstring>
+#include    <cstdlib>
+#include    <new>
+
+#include    <sys/mman.h>
 
 namespace pentifica::log {
+    /// @brief  The default Factory storage policy; allocates from the heap.
+    struct HeapStorage {
+        /// @brief  Allocate storage for a product
+        /// @param  size        The number of bytes to allocate
+        /// @param  alignment   The alignment of the allocation
+        /// @return The allocated storage
+        static void* Allocate(size_t size, size_t alignment) {
+            auto memory = std::aligned_alloc(alignment, size);
+            if(memory == nullptr) throw std::bad_alloc();
+            return memory;
+        }
+        /// @brief  Release storage allocated by Allocate
+        static void Deallocate(void* memory, size_t, size_t) noexcept { std::free(memory); }
+    };
+
+    /// @brief  A storage policy whose storage is shared by every product type
+    ///         (e.g. SizeClassStorage). Released products are returned to the
+    ///         policy rather than cached by the Factory. The policy provides
+    ///         static Reserve(size, alignment, count, lock),
+    ///         Capacity(size, alignment) and Available(size, alignment).
+    template<typename Storage>
+    concept SharedStorage = requires { requires Storage::shared; };
+
     /// @brief  Defines a Factory for creating instances of Event derived
     ///         classes. When a created instance is released, it is returned
     ///         to the Factory to be used when creating another instance.
     /// @tparam Product An Event derived class that must support the following
     ///                 minimal interface:
     ///                     - default ctor
-    template<typename Product>
+    /// @tparam Storage Policy providing the storage for products through
+    ///                 static Allocate(size, alignment) and
+    ///                 Deallocate(memory, size, alignment) methods
+    ///                 (default = HeapStorage). With SharedStorage, the
+    ///                 Factory keeps no cache of its own.
+    template<typename Product, typename Storage = HeapStorage>
     class Factory {
         /// @brief  Resets (via dtor) the derived Event instance and returns it to the
         ///         internal cache of the factory.
@@ -42,7 +75,13 @@ namespace pentifica::log {
         static void ReclaimEvent(Event* event);
         /// @brief  Frees the cached storage for an unused instance of Product
         /// @param  produce A reference to the unused instance of Product
-        static void ProductDeleter(Product* product) { std::free(product); }
+        static void ProductDeleter(Product* product) {
+            Storage::Deallocate(product, sizeof(Product), alignof(Product));
+        }
+        /// @brief  Allocates uninitialized storage for an instance of Product
+        static Product* AllocateProduct() {
+            return static_cast<Product*>(Storage::Allocate(sizeof(Product), alignof(Product)));
+        }
         using ProductList = std::forward_list<std::unique_ptr<Product, void(*)(Product*)>>;
         static constexpr auto memory_order = std::memory_order_relaxed;
         
@@ -63,7 +102,7 @@ namespace pentifica::log {
             if constexpr(std::is_base_of_v<Event, Product> && std::is_constructible_v<Product, Ts...>) {
                 Product* product{};
     
-                {
+                if constexpr(!SharedStorage<Storage>) {
                     std::lock_guard<std::mutex> lock(mutex_);
                     if(!free_products_.empty()) {
                         product = free_products_.front().release();
@@ -76,8 +115,16 @@ namespace pentifica::log {
                 }
     
                 else {
-                    product = new Product(std::forward<Ts>(params)...);
-                    capacity_.fetch_add(1, memory_order);
+                    auto memory = AllocateProduct();
+                    try {
+                        product = new(memory) Product(std::forward<Ts>(params)...);
+                    }
+                    catch(...) {
+                        ProductDeleter(memory);
+                        throw;
+                    }
+                    //  Shared storage grows its own pool; Capacity() reads it
+                    if constexpr(!SharedStorage<Storage>) capacity_.fetch_add(1, memory_order);
                 }
     
                 in_use_.fetch_add(1, memory_order);
@@ -95,10 +142,14 @@ namespace pentifica::log {
 
             if(increase == 0) return;
 
+            if constexpr(SharedStorage<Storage>) {
+                Storage::Reserve(sizeof(Product), alignof(Product), Available() + increase, false);
+                return;
+            }
+
             ProductList additional {};
             for(size_t i = 0; i < increase; i++) {
-                auto product = static_cast<Product*>(aligned_alloc(alignof(Product), sizeof(Product)));
-                additional.emplace_front(product, &ProductDeleter);
+                additional.emplace_front(AllocateProduct(), &ProductDeleter);
             }
 
             {
@@ -109,9 +160,44 @@ namespace pentifica::log {
             capacity_.fetch_add(increase, memory_order);
         }
 
-        static auto Capacity() { return capacity_.load(memory_order); }
+        /// @brief  Grows the cache to at least the capacity specified and
+        ///         touches every cached instance, so the first instances
+        ///         created do not take page faults. Optionally locks the
+        ///         cached instances into memory.
+        /// @param  capacity    The minimum size of the cache
+        /// @param  lock        Lock the cached instances into memory if true
+        /// @return False if any cached instance could not be locked
+        static bool Prewarm(size_t capacity, bool lock = false) {
+            if constexpr(SharedStorage<Storage>) {
+                return Storage::Reserve(sizeof(Product), alignof(Product), capacity, lock);
+            }
+
+            auto const current = Capacity();
+            if(capacity > current) AddCapacity(capacity - current);
 
-        static auto Available() { return capacity_.load(memory_order) - in_use_.load(memory_order); }
+            bool locked{true};
+            std::lock_guard<std::mutex> guard(mutex_);
+            for(auto& product : free_products_) {
+                std::memset(static_cast<void*>(product.get()), 0, sizeof(Product));
+                if(lock) locked &= mlock(product.get(), sizeof(Product)) == 0;
+            }
+            return locked;
+        }
+
+        /// @brief  The number of instances allocated by the cache; with
+        ///         SharedStorage, the capacity of the shared storage serving
+        ///         the Product
+        static size_t Capacity() {
+            if constexpr(SharedStorage<Storage>) return Storage::Capacity(sizeof(Product), alignof(Product));
+            else return capacity_.load(memory_order);
+        }
+        /// @brief  The number of cached instances not in use; with
+        ///         SharedStorage, the unused capacity of the shared storage
+        ///         serving the Product
+        static size_t Available() {
+            if constexpr(SharedStorage<Storage>) return Storage::Available(sizeof(Product), alignof(Product));
+            else return capacity_.load(memory_order) - in_use_.load(memory_order);
+        }
 
     private:
         static ProductList free_products_;
@@ -120,23 +206,29 @@ namespace pentifica::log {
         static std::mutex mutex_;
     };
 
-    template<typename T>
-    Factory<T>::ProductList Factory<T>::free_products_{};
+    template<typename T, typename S>
+    Factory<T, S>::ProductList Factory<T, S>::free_products_{};
     
-    template<typename T>
-    std::atomic<size_t> Factory<T>::capacity_{};
+    template<typename T, typename S>
+    std::atomic<size_t> Factory<T, S>::capacity_{};
     
-    template<typename T>
-    std::atomic<size_t> Factory<T>::in_use_{};
+    template<typename T, typename S>
+    std::atomic<size_t> Factory<T, S>::in_use_{};
 
-    template<typename T>
-    std::mutex Factory<T>::mutex_;
+    template<typename T, typename S>
+    std::mutex Factory<T, S>::mutex_;
     
-    template<typename T>
-    void Factory<T>::ReclaimEvent(Event* e) {
+    template<typename T, typename S>
+    void Factory<T, S>::ReclaimEvent(Event* e) {
         static_assert(std::is_base_of_v<Event, T>, "Not Derived from Event");
 
-        if constexpr(std::is_copy_assignable_v<T>) {
+        if constexpr(SharedStorage<S>) {
+            auto t = static_cast<T*>(e);
+            t->~T();
+            ProductDeleter(t);
+            in_use_.fetch_sub(1, memory_order);
+        }
+        else if constexpr(std::is_copy_assignable_v<T>) {
             auto t = static_cast<T*>(e);
             t->~T();
             {
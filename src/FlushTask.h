@@ -0,0 +1,130 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <coroutine>
+#include    <exception>
+#include    <functional>
+#include    <utility>
+
+namespace pentifica::log {
+/// @brief  A resumable flush operation. The task streams events in bounded
+///         slices and suspends between slices so the caller's event loop can
+///         decide when the sink is ready for more. The task is lazy; no events
+///         are streamed until it is first resumed or awaited.
+class FlushTask {
+public:
+    /// @brief  Called with the suspended task whenever a slice completes. The
+    ///         scheduler is expected to resume the handle at a later time,
+    ///         e.g. when the sink is writable again.
+    using Scheduler = std::function<void(std::coroutine_handle<>)>;
+
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /// @brief  Suspends the task at the end of a slice, handing it to the
+    ///         scheduler if one was supplied.
+    struct Yield {
+        Scheduler const& schedule_;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            if(schedule_) schedule_(handle);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        /// @brief  Number of events streamed by the completed task
+        size_t published_{};
+        /// @brief  Resumed when the task completes, if the task was awaited
+        std::coroutine_handle<> continuation_{};
+        std::exception_ptr exception_{};
+
+        FlushTask get_return_object() { return FlushTask{Handle::from_promise(*this)}; }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        auto final_suspend() const noexcept {
+            struct Final {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(Handle handle) const noexcept {
+                    auto continuation = handle.promise().continuation_;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+            return Final{};
+        }
+        void return_value(size_t published) noexcept { published_ = published; }
+        void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+    };
+
+    /// @brief Deleted
+    FlushTask(FlushTask const&) = delete;
+    /// @brief  Take ownership of the indicated task
+    /// @param  other   The task to take ownership of
+    FlushTask(FlushTask&& other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+    ~FlushTask() { if(handle_) handle_.destroy(); }
+    /// @brief Deleted
+    FlushTask& operator=(FlushTask const&) = delete;
+    /// @brief  Take ownership of the indicated task
+    /// @param  other   The task to take ownership of
+    FlushTask& operator=(FlushTask&& other) noexcept {
+        if(&other != this) {
+            if(handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    /// @brief  Stream the next slice of events
+    /// @return True if there are more slices to stream
+    bool Resume() {
+        if(Done()) return false;
+        handle_.resume();
+        Rethrow();
+        return !handle_.done();
+    }
+    /// @brief  Indicates if the task has streamed all the events it will
+    /// @return True if the task is complete
+    bool Done() const noexcept { return !handle_ || handle_.done(); }
+    /// @brief  The number of events streamed by a completed task
+    /// @return The number of events streamed
+    size_t Published() const noexcept { return handle_ ? handle_.promise().published_ : 0; }
+    /// @brief  Awaiting a task runs it, resuming the awaiting coroutine once
+    ///         the task completes. A Scheduler should be supplied when the task
+    ///         is awaited, otherwise nothing resumes the task between slices.
+    bool await_ready() const noexcept { return Done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation_ = awaiting;
+        return handle_;
+    }
+    size_t await_resume() {
+        Rethrow();
+        return Published();
+    }
+
+private:
+    explicit FlushTask(Handle handle) : handle_{handle} {}
+    void Rethrow() const {
+        if(handle_ && handle_.promise().exception_) {
+            std::rethrow_exception(handle_.promise().exception_);
+        }
+    }
+
+    Handle handle_;
+};
+}
\ No newline at end of file
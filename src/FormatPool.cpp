@@ -0,0 +1,87 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <FormatPool.h>
+
+namespace pentifica::log {
+FormatPool::FormatPool(size_t workers) {
+    workers_.reserve(workers);
+    for(size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] {
+            size_t generation{};
+            for(;;) {
+                std::function<void(size_t)> const* task{};
+                size_t count{};
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    start_.wait(lock, [&] { return stop_ || generation_ != generation; });
+                    if(stop_) return;
+                    generation = generation_;
+                    task = task_;
+                    count = count_;
+                    ++active_;
+                }
+                if(task) Work(*task, count);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --active_;
+                }
+                done_.notify_one();
+            }
+        });
+    }
+}
+
+FormatPool::~FormatPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for(auto& worker : workers_) worker.join();
+}
+
+void
+FormatPool::Run(size_t count, std::function<void(size_t)> const& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    start_.notify_all();
+
+    Work(task, count);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0 && next_.load(std::memory_order_relaxed) >= count_; });
+    task_ = nullptr;
+}
+
+void
+FormatPool::Work(std::function<void(size_t)> const& task, size_t count) {
+    for(;;) {
+        auto const index = next_.fetch_add(1, std::memory_order_relaxed);
+        if(index >= count) return;
+        task(index);
+    }
+}
+}
\ No newline at end of file
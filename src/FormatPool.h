@@ -0,0 +1,97 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <atomic>
+#include    <condition_variable>
+#include    <functional>
+#include    <mutex>
+#include    <streambuf>
+#include    <string>
+#include    <thread>
+#include    <vector>
+
+namespace pentifica::log {
+/// @brief  A fixed set of worker threads used to run the iterations of a
+///         task in parallel. The calling thread takes part in the work.
+class FormatPool {
+public:
+    /// @brief  Start the workers
+    /// @param  workers The number of worker threads
+    explicit FormatPool(size_t workers);
+    /// @brief Deleted
+    FormatPool(FormatPool const&) = delete;
+    /// @brief Deleted
+    FormatPool(FormatPool&&) = delete;
+    /// @brief  Stop the workers
+    ~FormatPool();
+    /// @brief Deleted
+    FormatPool& operator=(FormatPool const&) = delete;
+    /// @brief Deleted
+    FormatPool& operator=(FormatPool&&) = delete;
+    /// @brief  Run task(i) for every i in [0, count), returning once all the
+    ///         iterations have completed. Must not be called concurrently.
+    /// @param  count   The number of iterations
+    /// @param  task    The task to run
+    void Run(size_t count, std::function<void(size_t)> const& task);
+    /// @brief  The number of worker threads
+    size_t Workers() const noexcept { return workers_.size(); }
+
+private:
+    /// @brief  Run iterations of the task until none remain. The task and
+    ///         count are copied under the mutex by the caller, so a worker
+    ///         waking late never reads them while a new run sets them.
+    /// @param  task    The task to run
+    /// @param  count   The number of iterations
+    void Work(std::function<void(size_t)> const& task, size_t count);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    std::function<void(size_t)> const* task_{};
+    size_t count_{};
+    size_t generation_{};
+    size_t active_{};
+    bool stop_{false};
+    std::atomic<size_t> next_{};
+};
+/// @brief  A stream buffer appending to a string, so a formatting buffer can
+///         be cleared and reused without giving up its capacity.
+class StringSink :
+    public std::streambuf
+{
+public:
+    /// @brief  The characters written so far
+    std::string& Text() noexcept { return text_; }
+
+protected:
+    int_type overflow(int_type c) override {
+        if(!traits_type::eq_int_type(c, traits_type::eof())) text_.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(char const* text, std::streamsize count) override {
+        text_.append(text, static_cast<size_t>(count));
+        return count;
+    }
+
+private:
+    std::string text_;
+};
+}
\ No newline at end of file
@@ -21,7 +21,9 @@
 #include <Factory.h>
 #include <Utility.h>
 
+#include <concepts>
 #include <tuple>
+#include <typeinfo>
 
 namespace pentifica::log {
 /// @brief  Defines a generic Event class that can be instantiated with any value
@@ -31,10 +33,11 @@ template<typename... Fields>
 class GenericEvent :
     public Event
 {
-    using TupleType = std::tuple<Fields...>;
 public:
+    using TupleType = std::tuple<Fields...>;
+
     using Event::Event;
-    GenericEvent(Fields... fields) : data_{std::make_tuple(fields...)} {}
+    GenericEvent(Fields... fields) : data_{std::move(fields)...} {}
     virtual ~GenericEvent() = default;
     /// @brief  Streams the contained value types without any formatting
     ///         assumption
@@ -42,6 +45,42 @@ public:
     void Log(std::ostream& os) const override {
         os << data_;
     }
+    /// @brief  Events are equivalent when they are the same type and all the
+    ///         fields compare equal.
+    /// @param  other   The Event to compare against
+    /// @return True if the events carry the same information
+    bool Equivalent(Event const& other) const override {
+        if constexpr((std::equality_comparable<Fields> && ...)) {
+            return typeid(other) == typeid(*this) &&
+                static_cast<GenericEvent const&>(other).data_ == data_;
+        }
+        else {
+            return false;
+        }
+    }
+
+    /// @brief  The memory used by the Event, including memory owned by the
+    ///         fields
+    /// @return The number of bytes used by the Event
+    size_t Footprint() const noexcept override {
+        return sizeof(*this) +
+            std::apply([](auto const&... fields) { return (size_t{} + ... + FieldFootprint(fields)); }, data_);
+    }
+    /// @brief  Pass each field to the visitor
+    /// @param  visitor Receives the fields
+    void Visit(FieldVisitor& visitor) const override {
+        std::apply([&visitor](auto const&... fields) { (VisitField(visitor, fields), ...); }, data_);
+    }
+    /// @brief  Renders the fields that can be rendered safely
+    /// @param  writer  Where to render the fields
+    void Snapshot(SnapshotWriter& writer) const noexcept override {
+        std::apply([&writer](auto const&... fields) { (writer.Write(fields), ...); }, data_);
+    }
+
+protected:
+    /// @brief  The captured values
+    /// @return The captured values
+    TupleType const& Data() const noexcept { return data_; }
 
 private:
     TupleType data_;
@@ -0,0 +1,83 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <HugePageArena.h>
+
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+namespace pentifica::log {
+HugePageArena::HugePageArena(size_t capacity, bool prefault) :
+    capacity_{(capacity + huge_page_size - 1) / huge_page_size * huge_page_size}
+{
+    if(capacity_ == 0) capacity_ = huge_page_size;
+
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    auto memory = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    huge_pages_ = memory != MAP_FAILED;
+    if(!huge_pages_) {
+        memory = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(memory == MAP_FAILED) throw std::bad_alloc();
+        madvise(memory, capacity_, MADV_HUGEPAGE);
+    }
+    base_ = static_cast<std::byte*>(memory);
+
+    // Allocate pages on the node of the faulting thread, even when the
+    // process policy is to interleave.
+    syscall(SYS_mbind, memory, capacity_, MPOL_LOCAL, nullptr, 0, 0);
+
+    if(prefault) {
+        auto const page_size = huge_pages_ ? huge_page_size : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for(size_t offset = 0; offset < capacity_; offset += page_size) {
+            base_[offset] = std::byte{};
+        }
+    }
+}
+
+HugePageArena::~HugePageArena() {
+    munmap(base_, capacity_);
+}
+
+void*
+HugePageArena::Allocate(size_t size, size_t alignment) noexcept {
+    auto used = used_.load(std::memory_order_relaxed);
+    for(;;) {
+        auto const address = reinterpret_cast<std::uintptr_t>(base_) + used;
+        auto const aligned = (address + alignment - 1) / alignment * alignment;
+        auto const end = aligned - reinterpret_cast<std::uintptr_t>(base_) + size;
+        if(end > capacity_) return nullptr;
+        if(used_.compare_exchange_weak(used, end, std::memory_order_relaxed)) {
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+}
+
+HugePageArena&
+HugePageArena::Default() {
+    //  Never destroyed: Factory pools and allocators may release into it
+    //  during static destruction
+    static auto* arena = new HugePageArena{default_capacity_.load(std::memory_order_relaxed), false};
+    return *arena;
+}
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <atomic>
+#include    <cstddef>
+#include    <cstdlib>
+#include    <new>
+
+namespace pentifica::log {
+/// @brief  A monotonic arena backed by 2 MB huge pages. The arena is mapped
+///         with MAP_HUGETLB when the system has huge pages reserved, falling
+///         back to regular pages advised for transparent huge pages. Pages
+///         are bound to the NUMA node of the thread that first touches them,
+///         so an arena that is prefaulted (or first used) by the thread that
+///         uses it is node local. Memory is never returned to the arena; it
+///         is intended for long lived rings and pools.
+class HugePageArena {
+public:
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+    /// @brief  Map an arena
+    /// @param  capacity    The size of the arena, rounded up to a multiple of
+    ///                     the huge page size
+    /// @param  prefault    Touch every page of the arena from the calling
+    ///                     thread
+    /// @throws std::bad_alloc if the arena could not be mapped
+    explicit HugePageArena(size_t capacity, bool prefault = true);
+    /// @brief Deleted
+    HugePageArena(HugePageArena const&) = delete;
+    /// @brief Deleted
+    HugePageArena(HugePageArena&&) = delete;
+    /// @brief  Unmaps the arena
+    ~HugePageArena();
+    /// @brief Deleted
+    HugePageArena& operator=(HugePageArena const&) = delete;
+    /// @brief Deleted
+    HugePageArena& operator=(HugePageArena&&) = delete;
+    /// @brief  Allocate from the arena. Thread safe.
+    /// @param  size        The number of bytes to allocate
+    /// @param  alignment   The alignment of the allocation
+    /// @return The allocation, or nullptr if the arena is exhausted
+    void* Allocate(size_t size, size_t alignment) noexcept;
+    /// @brief  Indicates if the memory was allocated from this arena
+    /// @param  memory  The memory to check
+    /// @return True if the memory belongs to the arena
+    bool Owns(void const* memory) const noexcept {
+        auto const address = static_cast<std::byte const*>(memory);
+        return address >= base_ && address < base_ + capacity_;
+    }
+    /// @brief  Indicates if the arena is mapped with explicit huge pages
+    bool HugePages() const noexcept { return huge_pages_; }
+    /// @brief  The size of the arena
+    size_t Capacity() const noexcept { return capacity_; }
+    /// @brief  The number of bytes allocated from the arena
+    size_t Used() const noexcept { return used_.load(std::memory_order_relaxed); }
+    /// @brief  Set the capacity of the default arena. Has no effect once the
+    ///         default arena has been used.
+    /// @param  capacity    The size of the default arena
+    static void SetDefaultCapacity(size_t capacity) noexcept {
+        default_capacity_.store(capacity, std::memory_order_relaxed);
+    }
+    /// @brief  The process wide arena used by ArenaStorage and, by default,
+    ///         ArenaAllocator. It is mapped on first use and not prefaulted,
+    ///         so pages are local to the threads that first touch them.
+    ///         It is never unmapped, so it outlives every static user.
+    static HugePageArena& Default();
+
+private:
+    std::byte* base_{};
+    size_t capacity_{};
+    bool huge_pages_{};
+    std::atomic<size_t> used_{};
+
+    inline static std::atomic<size_t> default_capacity_{64 * 1024 * 1024};
+};
+/// @brief  A standard allocator drawing from a HugePageArena, for use as the
+///         Allocator of a RingBuffer. Memory from the arena is never
+///         reclaimed, so each RingBuffer::Resize strands the old cache in the
+///         arena; once the arena is exhausted, allocations fall back to the
+///         heap and those are freed on deallocation.
+/// @tparam T   The allocated type
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena_{&HugePageArena::Default()} {}
+    explicit ArenaAllocator(HugePageArena& arena) noexcept : arena_{&arena} {}
+    template<typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) noexcept : arena_{other.arena_} {}
+
+    T* allocate(size_t count) {
+        auto memory = arena_->Allocate(count * sizeof(T), alignof(T));
+        if(memory == nullptr) memory = ::operator new(count * sizeof(T), std::align_val_t{alignof(T)});
+        return static_cast<T*>(memory);
+    }
+    void deallocate(T* memory, size_t) noexcept {
+        if(!arena_->Owns(memory)) ::operator delete(memory, std::align_val_t{alignof(T)});
+    }
+
+    template<typename U>
+    bool operator==(ArenaAllocator<U> const& other) const noexcept { return arena_ == other.arena_; }
+
+private:
+    template<typename U> friend class ArenaAllocator;
+    HugePageArena* arena_;
+};
+/// @brief  Factory storage policy drawing from the default HugePageArena,
+///         falling back to the heap once the arena is exhausted.
+struct ArenaStorage {
+    static void* Allocate(size_t size, size_t alignment) {
+        auto memory = HugePageArena::Default().Allocate(size, alignment);
+        if(memory == nullptr) memory = std::aligned_alloc(alignment, size);
+        if(memory == nullptr) throw std::bad_alloc();
+        return memory;
+    }
+    static void Deallocate(void* memory, size_t, size_t) noexcept {
+        if(!HugePageArena::Default().Owns(memory)) std::free(memory);
+    }
+};
+}
\ No newline at end of file
@@ -19,6 +19,13 @@
 /// SOFTWARE.
 
 #include <Manager.h>
+#include <Utility.h>
+#include <Columnar.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <unistd.h>
 
 namespace pentifica::log {
 Manager::Manager(std::ostream& os, size_t capacity) :
@@ -28,22 +35,307 @@ Manager::Manager(std::ostream& os, size_t capacity) :
 }
 
 void
-Manager::Flush(size_t count) {
-    while(count--) {
+Manager::Write(std::ostream& os, Event const& event) const {
+    if(format_ == Format::JsonLines) os << AsJson{event};
+    else os << event;
+}
+
+void
+Manager::EnqueueBudgeted(EventRef&& event) {
+    //  Without a budget the event is not charged; events still charged from
+    //  an earlier budget are released when they are overwritten
+    auto const budget = budget_.load(std::memory_order_relaxed);
+    auto const footprint = budget != 0 ? event->Footprint() : 0;
+    bytes_queued_.fetch_add(footprint, std::memory_order_relaxed);
+    if(auto evicted = queue_->EnqueueEvict(Wrapper(std::move(event), footprint))) Release(*evicted);
+    if(budget == 0) return;
+
+    while(bytes_queued_.load(std::memory_order_relaxed) > budget) {
+        auto oldest = queue_->Dequeue();
+        if(!oldest) break;
+        Release(*oldest);
+        events_evicted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool
+Manager::PublishNext() {
+    if(recorder_) return RecordNext();
+    auto wrapper = queue_->Dequeue();
+    if(!wrapper) return false;
+    Release(*wrapper);
+    Publish(std::move((*wrapper).event_));
+    return true;
+}
+
+bool
+Manager::RecordNext() {
+    auto& recorder = *recorder_;
+    for(;;) {
+        //  Triggers are counted before they are enqueued, so handled_ only
+        //  passes triggers_ for triggers enqueued before the recorder was set
+        bool const pending = recorder.handled_ < triggers_.load(std::memory_order_relaxed);
+        //  The most recent events stay in the queue as the window of a later trigger
+        if(!pending && recorder.remaining_ == 0 && queue_->Length() <= recorder.before_) {
+            recorder.window_.clear();
+            return false;
+        }
+
         auto wrapper = queue_->Dequeue();
-        if(!wrapper) break;
-        os_ << *((*wrapper).event_);
-        events_published_.fetch_add(1, std::memory_order_relaxed);
+        if(!wrapper) {
+            //  A missing trigger is either still being enqueued or was
+            //  overwritten; it is taken as overwritten if it is still
+            //  missing the next time the queue is emptied
+            recorder.handled_ = std::max(recorder.handled_, recorder.counted_);
+            recorder.counted_ = triggers_.load(std::memory_order_relaxed);
+            return false;
+        }
+        Release(*wrapper);
+
+        auto& event = (*wrapper).event_;
+        if(event->GetSeverity() >= recorder.trigger_) {
+            ++recorder.handled_;
+            for(auto& held : recorder.window_) Publish(std::move(held.event_));
+            recorder.window_.clear();
+            Publish(std::move(event));
+            recorder.remaining_ = recorder.after_;
+            return true;
+        }
+        if(recorder.remaining_ > 0) {
+            --recorder.remaining_;
+            Publish(std::move(event));
+            return true;
+        }
+        //  Discarded events do not count towards a bounded flush
+        if(pending && recorder.before_ > 0) {
+            if(recorder.window_.size() == recorder.before_) recorder.window_.pop_front();
+            recorder.window_.push_back(std::move(*wrapper));
+        }
+    }
+}
+
+void
+Manager::Publish(EventRef&& event) {
+    for(auto& route : routes_) {
+        if(route->filter_.Matches(*event)) {
+            route->queue_.Enqueue(Wrapper(std::move(event)));
+            route->routed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    events_published_.fetch_add(1, std::memory_order_relaxed);
+    if(columnar_) {
+        columnar_->Append(*event);
+        return;
+    }
+    if(!coalesce_) {
+        Emit(Run{Wrapper(std::move(event))});
+        return;
+    }
+
+    auto& first = run_.first_.event_;
+    if(first &&
+       first->GetSeverity() == event->GetSeverity() &&
+       first->Equivalent(*event)) {
+        if(run_.repeats_++ == 0) run_.repeat_first_ = event->GetTime();
+        run_.repeat_last_ = event->GetTime();
+        events_coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    EndRun();
+    first = std::move(event);
+}
+
+void
+Manager::EndRun() {
+    if(!run_.first_.event_) return;
+    Emit(std::move(run_));
+    run_ = Run{};
+}
+
+void
+Manager::Summarize() {
+    metrics_.Collect([this](EventRef&& summary) { Publish(std::move(summary)); });
+}
+
+void
+Manager::Emit(Run&& run) {
+    if(!pool_) {
+        Render(os_, run);
+        return;
+    }
+    batch_.push_back(std::move(run));
+    if(batch_.size() >= parallel_threshold * chunks_.size()) FormatBatch();
+}
+
+void
+Manager::Render(std::ostream& os, Run const& run) const {
+    Write(os, *run.first_.event_);
+    if(run.repeats_ > 0 && format_ == Format::JsonLines) {
+        os << "{\"repeated\":" << run.repeats_ << ",\"first\":\"";
+        StreamTime(os, run.repeat_first_) << "\",\"last\":\"";
+        StreamTime(os, run.repeat_last_) << "\"}\n";
     }
+    else if(run.repeats_ > 0) {
+        os << "    last event repeated " << run.repeats_ << " times between ";
+        StreamTime(os, run.repeat_first_) << " and ";
+        StreamTime(os, run.repeat_last_) << '\n';
+    }
+}
+
+void
+Manager::Complete() {
+    EndRun();
+    FormatBatch();
+}
+
+void
+Manager::FormatBatch() {
+    if(batch_.empty()) return;
+
+    if(batch_.size() < parallel_threshold) {
+        for(auto const& run : batch_) Render(os_, run);
+        batch_.clear();
+        return;
+    }
+
+    auto const chunk_count = std::min(chunks_.size(), batch_.size());
+    auto const chunk_size = (batch_.size() + chunk_count - 1) / chunk_count;
+    pool_->Run(chunk_count, [this, chunk_size](size_t index) {
+        auto& chunk = *chunks_[index];
+        auto const first = index * chunk_size;
+        auto const last = std::min(first + chunk_size, batch_.size());
+        for(auto i = first; i < last; ++i) Render(chunk.os_, batch_[i]);
+    });
+
+    for(size_t index = 0; index < chunk_count; ++index) {
+        auto& text = chunks_[index]->sink_.Text();
+        os_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        text.clear();
+    }
+    batch_.clear();
+}
+
+void
+Manager::SetFormatWorkers(size_t workers) {
+    Complete();
+    chunks_.clear();
+    pool_.reset();
+    if(workers == 0) return;
+
+    pool_ = std::make_unique<FormatPool>(workers);
+    for(size_t i = 0; i <= workers; ++i) chunks_.push_back(std::make_unique<Chunk>());
+}
+
+void
+Manager::Flush(size_t count) {
+    while(count-- && PublishNext()) {}
+    Summarize();
+    Complete();
+    if(columnar_) columnar_->FlushExpired();
+}
+
+FlushTask
+Manager::FlushAsync(size_t count, std::chrono::microseconds slice, FlushTask::Scheduler schedule) {
+    using Clock = std::chrono::steady_clock;
+
+    size_t published{};
+    auto deadline = Clock::now() + slice;
+    while(published < count && PublishNext()) {
+        ++published;
+        if(published < count && Clock::now() >= deadline && !queue_->Empty()) {
+            Complete();
+            co_await FlushTask::Yield{schedule};
+            deadline = Clock::now() + slice;
+        }
+    }
+    Summarize();
+    Complete();
+    if(columnar_) columnar_->FlushExpired();
+    co_return published;
 }
 
 void
 Manager::Dump() {
-    for(;;) {
-        auto wrapper = queue_->Dequeue();
+    while(PublishNext()) {}
+    Summarize();
+    Complete();
+    if(columnar_) columnar_->Flush();
+    for(size_t route = 0; route < routes_.size(); ++route) {
+        DrainRoute(route, std::numeric_limits<size_t>::max());
+    }
+}
+
+void
+Manager::DrainRoute(size_t index, size_t count) {
+    auto& route = *routes_.at(index);
+    std::lock_guard<std::mutex> lock(route.drain_mutex_);
+    while(count--) {
+        auto wrapper = route.queue_.Dequeue();
         if(!wrapper) break;
-        os_ << *((*wrapper).event_);
+        Write(route.os_, *((*wrapper).event_));
+        route.published_.fetch_add(1, std::memory_order_relaxed);
         events_published_.fetch_add(1, std::memory_order_relaxed);
     }
 }
+
+bool
+Manager::Lock() const {
+    bool locked = queue_->Lock();
+    for(auto const& route : routes_) locked &= route->queue_.Lock();
+    return locked;
+}
+
+void
+Manager::CrashDump(int fd) const noexcept {
+    auto dump = [fd](Wrapper const& wrapper) noexcept {
+        auto const event = wrapper.event_.get();
+        if(event == nullptr) return;
+
+        char line[1024];
+        SnapshotWriter writer{line, sizeof(line) - 1};
+        auto const micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            event->GetTime().time_since_epoch()).count();
+        writer.Write(micros / 1000000).Write('.');
+        auto const fraction = micros % 1000000;
+        for(auto scale = 100000; scale > 1 && fraction < scale; scale /= 10) writer.Write('0');
+        writer.Write(fraction).Write(" [").Write(ToString(event->GetSeverity())).Write("] ");
+        event->Snapshot(writer);
+
+        auto text = writer.View();
+        line[text.size()] = '\n';
+        auto remaining = text.size() + 1;
+        auto next = static_cast<char const*>(line);
+        while(remaining > 0) {
+            auto const written = ::write(fd, next, remaining);
+            if(written <= 0) return;
+            next += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    };
+
+    //  Accepted events not yet written: those awaiting formatting, the run
+    //  being coalesced and the flight recorder window, then the queues
+    for(size_t i = 0; i < batch_.size(); ++i) dump(batch_[i].first_);
+    dump(run_.first_);
+    if(recorder_) {
+        for(auto const& held : recorder_->window_) dump(held);
+    }
+    queue_->VisitUnlocked(dump);
+    for(auto const& route : routes_) route->queue_.VisitUnlocked(dump);
+}
+
+RouteStats
+Manager::GetRouteStats(size_t index) const {
+    auto const& route = *routes_.at(index);
+    RouteStats stats;
+    stats.published_ = route.published_.load(std::memory_order_relaxed);
+    stats.pending_ = route.queue_.Length();
+    stats.routed_ = route.routed_.load(std::memory_order_relaxed);
+    stats.dropped_ = route.queue_.Overruns();
+    stats.cleared_ = route.cleared_.load(std::memory_order_relaxed);
+    return stats;
+}
 }
\ No newline at end of file
@@ -21,12 +21,70 @@
 
 #include <Event.h>
 #include <RingBuffer.h>
+#include <FlushTask.h>
+#include <FormatPool.h>
+#include <Metrics.h>
+#include <Trace.h>
 
 #include <memory>
 #include <iostream>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
 namespace pentifica::log {
+class ColumnarSink;
+/// @brief  Selects the events delivered to a route. An event matches if its
+///         Severity is within the configured range and, when event types
+///         are configured, its type is one of them.
+struct RouteFilter {
+    Severity min_severity_{Severity::Debug};
+    Severity max_severity_{Severity::Fatal};
+    std::vector<std::type_index> types_{};
+
+    /// @brief  Restrict the filter to the indicated event types
+    /// @tparam ...Products The Event derived types to accept
+    /// @return This filter
+    template<typename... Products>
+    RouteFilter& Types() {
+        (types_.emplace_back(typeid(Products)), ...);
+        return *this;
+    }
+    /// @brief  Indicates if the event should be delivered to the route
+    /// @param  event   The event to check
+    /// @return True if the event matches
+    bool Matches(Event const& event) const {
+        auto const severity = event.GetSeverity();
+        if(severity < min_severity_ || severity > max_severity_) return false;
+        if(types_.empty()) return true;
+        std::type_index const type{typeid(event)};
+        for(auto const& match : types_) {
+            if(match == type) return true;
+        }
+        return false;
+    }
+};
+/// @brief  Throughput counters for a route
+struct RouteStats {
+    /// @brief  Events delivered to the route queue
+    size_t routed_{};
+    /// @brief  Events streamed to the route sink
+    size_t published_{};
+    /// @brief  Events waiting in the route queue
+    size_t pending_{};
+    /// @brief  Events lost to overrun of the route queue
+    size_t dropped_{};
+    /// @brief  Events discarded by Manager::Clear
+    size_t cleared_{};
+};
+
 /// @brief  A multi-threaded manager for aggregating and streaming Events. The
 ///         design uses a circular lock-free queue to aggregate incoming events.
 ///         On demand, the manage will stream events to a designated stream. If
@@ -37,20 +95,64 @@ class Manager {
     ///         events in a queue
     struct Wrapper {
         EventRef event_;
+        /// @brief  The Event footprint charged to the memory budget
+        size_t footprint_{};
         Wrapper() : event_{nullptr, nullptr} {}
         Wrapper(Wrapper const&) : event_{nullptr, nullptr} {}
-        Wrapper(Wrapper&& other) : event_(std::move(other.event_)) {}
-        Wrapper(EventRef&& event) : event_(std::move(event)) {}
+        Wrapper(Wrapper&& other) noexcept :
+            event_(std::move(other.event_)), footprint_{std::exchange(other.footprint_, 0)} {}
+        Wrapper(EventRef&& event, size_t footprint = 0) :
+            event_(std::move(event)), footprint_{footprint} {}
         ~Wrapper() = default;
         Wrapper& operator=(Wrapper const&) = delete;
-        Wrapper& operator=(Wrapper&& other) {
+        Wrapper& operator=(Wrapper&& other) noexcept {
             event_ = std::move(other.event_);
+            footprint_ = std::exchange(other.footprint_, 0);
             return *this;
         }
     };
     using EventRingBuffer = RingBuffer<Wrapper>;
+    /// @brief  A sink with its own queue, drained independently of the
+    ///         manager's stream.
+    struct Route {
+        std::ostream& os_;
+        RouteFilter const filter_;
+        EventRingBuffer queue_;
+        /// @brief  Serializes draining so output is in order
+        std::mutex drain_mutex_{};
+        std::atomic<size_t> routed_{};
+        std::atomic<size_t> published_{};
+        std::atomic<size_t> cleared_{};
+        Route(std::ostream& os, RouteFilter filter, size_t capacity) :
+            os_{os}, filter_{std::move(filter)}, queue_{capacity} {}
+    };
+    /// @brief  Flight recorder state. The queue itself holds the most recent
+    ///         events; the window only holds the events preceding a trigger
+    ///         while the queue is drained to reach it.
+    struct Recorder {
+        Severity const trigger_;
+        size_t const before_;
+        size_t const after_;
+        size_t remaining_{};
+        /// @brief  Triggers found when flushing
+        size_t handled_{};
+        /// @brief  Triggers counted when the queue was last emptied
+        size_t counted_{};
+        std::deque<Wrapper> window_{};
+        Recorder(Severity trigger, size_t before, size_t after) :
+            trigger_{trigger}, before_{before}, after_{after} {}
+    };
+    /// @brief  Trigger value when not in flight recorder mode
+    static constexpr unsigned no_trigger = 1u << 8;
 
 public:
+    /// @brief  How events are written to the streams
+    enum class Format {
+        /// @brief  One line of text per event (see operator<<)
+        Text,
+        /// @brief  One JSON object per line (see AsJson)
+        JsonLines,
+    };
     /// @brief  Prepare an event manager that can enqueue, at most, capacity
     ///         events without overrun.
     /// @param os           Where to stream events
@@ -66,29 +168,343 @@ public:
     /// @brief  Enqueue a log event.
     /// @param  event   Enqueue the log event.
     void Enqueue(EventRef&& event) {
-        queue_->Enqueue(Wrapper(std::move(event)));
         ++events_received_;
+        if(auto trace = trace_.load(std::memory_order_relaxed)) trace->Record(*event);
+        if(aggregate_.load(std::memory_order_relaxed) && event->Fold(metrics_)) {
+            ++events_aggregated_;
+            return;
+        }
+        //  Counted first, so a flush never finds a trigger it has not counted
+        if(event->GetSeverity() >= trigger_.load(std::memory_order_relaxed)) {
+            triggers_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if(Charging()) EnqueueBudgeted(std::move(event));
+        else queue_->Enqueue(Wrapper(std::move(event)));
     }
+    /// @brief  Enqueue the indicated log events, in order, with a single
+    ///         claim on the queue.
+    /// @param  events  The log events to enqueue. They are moved from.
+    void EnqueueBatch(std::span<EventRef> events) { EnqueueStaged(events); }
+    /// @brief  Stages events on the producer's stack and enqueues them with a
+    ///         single claim on the queue when the stage is full or the Batch
+    ///         goes out of scope, so related events stay contiguous, e.g.
+    ///             Manager::Batch batch(manager);
+    ///             batch.Enqueue(...);
+    ///             batch.Enqueue(...);
+    /// @tparam Capacity    The number of events staged before they are
+    ///                     enqueued
+    template<size_t Capacity = 16>
+    class Batch {
+    public:
+        /// @brief  Prepare an empty stage for the indicated manager
+        /// @param  manager Where the staged events are enqueued
+        explicit Batch(Manager& manager) : manager_{manager} {}
+        /// @brief Deleted
+        Batch(Batch const&) = delete;
+        /// @brief  Enqueue any staged events
+        ~Batch() { Commit(); }
+        /// @brief Deleted
+        Batch& operator=(Batch const&) = delete;
+        /// @brief  Stage a log event, enqueuing the stage if it is full
+        /// @param  event   The log event to stage
+        void Enqueue(EventRef&& event) {
+            staged_[size_++] = Wrapper(std::move(event));
+            if(size_ == Capacity) Commit();
+        }
+        /// @brief  Enqueue the staged events
+        void Commit() {
+            manager_.EnqueueStaged(std::span<Wrapper>(staged_.data(), size_));
+            size_ = 0;
+        }
+        /// @brief  The number of staged events
+        /// @return The number of staged events
+        size_t Size() const noexcept { return size_; }
+
+    private:
+        Manager& manager_;
+        std::array<Wrapper, Capacity> staged_{};
+        size_t size_{};
+    };
     /// @brief  Stream, at most, the configured number of Event messages from
-    ///         the internal queue.
+    ///         the internal queue. In flight recorder mode, events the
+    ///         recorder discards are not counted; the events preceding a
+    ///         trigger are streamed with it and count as one.
     /// @param  count   Max number of messages to stream from the queue
     void Flush(size_t count);
-    /// @brief  Stream all Event messages from the inernal queue.
+    /// @brief  Stream, at most, the configured number of Event messages from
+    ///         the internal queue without blocking the caller for longer than
+    ///         a slice. Once a slice has run for the indicated duration, the
+    ///         task suspends and is handed to the scheduler (if any) to be
+    ///         resumed later. The manager must outlive the returned task.
+    /// @param  count       Max number of messages to stream from the queue,
+    ///                     counted as by Flush
+    /// @param  slice       Max time to spend streaming before suspending
+    /// @param  schedule    Invoked with the suspended task after each slice
+    /// @return The task performing the flush
+    FlushTask FlushAsync(size_t count,
+                         std::chrono::microseconds slice,
+                         FlushTask::Scheduler schedule = {});
+    /// @brief  Stream all Event messages from the inernal queue, and from
+    ///         the queues of all routes.
     void Dump();
-    /// @brief  Clear all Events from the internal queue.
-    void Clear() { queue_->Clear(); }
+    /// @brief  Clear all Events from the internal queue, from the queues of
+    ///         all routes. Pending flight recorder triggers are discarded.
+    void Clear() {
+        while(auto wrapper = queue_->Dequeue()) Release(*wrapper);
+        for(auto& route : routes_) {
+            std::lock_guard<std::mutex> lock(route->drain_mutex_);
+            while(route->queue_.Dequeue()) route->cleared_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if(recorder_) {
+            recorder_->window_.clear();
+            recorder_->remaining_ = 0;
+            recorder_->handled_ = recorder_->counted_ = triggers_.load(std::memory_order_relaxed);
+        }
+    }
+    /// @brief  Lock the storage of the internal queue and route queues into
+    ///         memory.
+    /// @return False if any storage could not be locked
+    bool Lock() const;
+    /// @brief  Write every pending event, including those held by routes,
+    ///         batched for formatting, in the current coalesced run or in
+    ///         the flight recorder window, using only async-signal-safe
+    ///         operations. Text already formatted by the format workers but
+    ///         not yet written is not included.
+    ///         Events are not dequeued. Intended to be called from a fatal
+    ///         signal handler (see CrashHandler).
+    /// @param  fd  Where to write the events
+    void CrashDump(int fd) const noexcept;
+    /// @brief  Switch to flight recorder mode. Enqueued events are held in
+    ///         the queue, overwriting the oldest, and nothing is streamed
+    ///         until an event at or above the trigger Severity is enqueued.
+    ///         Flushing then streams the events preceding the trigger, the
+    ///         trigger and the events that follow it. A trigger arriving
+    ///         while following events are streamed extends the window.
+    ///         Without a trigger, flushing discards all but the most recent
+    ///         before events. The queue capacity must cover the window and
+    ///         the events enqueued between flushes.
+    /// @param  trigger The Severity that triggers streaming
+    /// @param  before  Number of events preceding a trigger to stream
+    /// @param  after   Number of events following a trigger to stream
+    void SetFlightRecorder(Severity trigger, size_t before, size_t after) {
+        recorder_ = std::make_unique<Recorder>(trigger, before, after);
+        recorder_->handled_ = recorder_->counted_ = triggers_.load(std::memory_order_relaxed);
+        trigger_.store(trigger, std::memory_order_relaxed);
+    }
+    /// @brief  Leave flight recorder mode. Events already enqueued are
+    ///         streamed by the next flush.
+    void ClearFlightRecorder() {
+        trigger_.store(no_trigger, std::memory_order_relaxed);
+        recorder_.reset();
+    }
+    /// @brief  Number of flight recorder triggers enqueued
+    auto Triggers() const {
+        return triggers_.load(std::memory_order_relaxed);
+    }
+    /// @brief  Add a route. When events are flushed, each event is checked
+    ///         against the routes in the order they were added. The first
+    ///         route with a matching filter takes the event into its own
+    ///         queue; unmatched events are streamed to the manager's stream.
+    ///         Routes must be added before events are flushed.
+    /// @param  os          Where the route streams events
+    /// @param  filter      Selects the events delivered to the route
+    /// @param  capacity    The max number of events the route can queue
+    ///                     before older events are overwritten
+    /// @return Identifies the route
+    size_t AddRoute(std::ostream& os, RouteFilter filter, size_t capacity) {
+        routes_.push_back(std::make_unique<Route>(os, std::move(filter), capacity));
+        return routes_.size() - 1;
+    }
+    /// @brief  Stream, at most, the configured number of Event messages from
+    ///         the queue of a route. Routes may be drained concurrently.
+    /// @param  route   Identifies the route
+    /// @param  count   Max number of messages to stream from the route
+    void DrainRoute(size_t route, size_t count);
+    /// @brief  The throughput counters of a route
+    /// @param  route   Identifies the route
+    /// @return The route counters
+    RouteStats GetRouteStats(size_t route) const;
+    /// @brief  Set how events are written to the manager's stream and to
+    ///         the streams of all routes.
+    /// @param  format  The output format
+    void SetFormat(Format format) { format_ = format; }
+    /// @brief  Change the number of events the queue can hold without
+    ///         overrun, keeping the queued events in order. Producers wait
+    ///         while the queued events are migrated. If fewer events than are
+    ///         queued fit, the oldest are dropped (see Dropped).
+    /// @param  capacity    The new capacity of the queue; must not be 0
+    void Resize(size_t capacity) {
+        queue_->Resize(capacity, [this](Wrapper&& dropped) { Release(dropped); });
+    }
+    /// @brief  The number of events the queue can hold without overrun
+    auto Capacity() const { return queue_->Capacity(); }
+    /// @brief  Bound the memory used by queued events, rather than only the
+    ///         number of events. The footprint of each event (see
+    ///         Event::Footprint) is charged to the budget when it is enqueued;
+    ///         while the budget is exceeded, the oldest events are dropped.
+    ///         The capacity of the queue still limits the number of events.
+    ///         Events held by routes are not charged. Events charged before
+    ///         the budget is removed are released as they are dequeued or
+    ///         overwritten.
+    /// @param  bytes   The memory budget (0 = unlimited)
+    void SetMemoryBudget(size_t bytes) { budget_.store(bytes, std::memory_order_relaxed); }
+    /// @brief  The memory charged to the budget by queued events
+    auto BytesQueued() const {
+        return bytes_queued_.load(std::memory_order_relaxed);
+    }
+    /// @brief  Total number of events dropped from the queue before they
+    ///         could be streamed, due to overrun or the memory budget
+    auto Dropped() const {
+        return queue_->Overruns() + events_evicted_.load(std::memory_order_relaxed);
+    }
+    /// @brief  Format events for the manager's stream on a pool of worker
+    ///         threads. Each flush splits the events to be streamed into
+    ///         chunks, formats the chunks in parallel into separate buffers,
+    ///         then writes the buffers to the stream in the original order.
+    ///         Small flushes are formatted on the calling thread.
+    /// @param  workers The number of worker threads (0 = format on the
+    ///                 calling thread only)
+    void SetFormatWorkers(size_t workers);
+    /// @brief  Enable or disable coalescing of repeated events. When enabled,
+    ///         consecutive events that are equivalent (see Event::Equivalent)
+    ///         and have the same Severity are streamed once, followed by a
+    ///         line noting how many times, and over what period, the event
+    ///         was repeated. Runs are not carried across calls to Flush.
+    /// @param  enable  Coalesce repeated events if true
+    void SetCoalescing(bool enable) { coalesce_ = enable; }
+    /// @brief  Enable or disable metrics aggregation. When enabled, events
+    ///         that support aggregation (see MetricEvent) are folded into
+    ///         per-thread counters and histograms when they are enqueued,
+    ///         instead of being queued. Each flush streams one MetricSummary
+    ///         per aggregated type covering the period since the last flush.
+    /// @param  enable  Aggregate events if true
+    void SetAggregation(bool enable) { aggregate_.store(enable, std::memory_order_relaxed); }
+    /// @brief  Write published events to per type columnar files instead of
+    ///         the manager's stream. Routes and the flight recorder still
+    ///         apply; events are not coalesced. Blocks are written as they
+    ///         fill, partial blocks by Dump, and partial blocks that have
+    ///         reached the sink's maximum age at the end of every flush.
+    /// @param  sink    Where to write events (nullptr = the stream); must
+    ///                 outlive its use
+    void SetColumnar(ColumnarSink* sink) { columnar_ = sink; }
+    /// @brief  Record every enqueued event to a trace, e.g. to replay real
+    ///         traffic against a different configuration (see Replay)
+    /// @param  trace   Where to record events (nullptr = stop recording);
+    ///                 must outlive the recording
+    void SetTrace(TraceRecorder* trace) { trace_.store(trace, std::memory_order_relaxed); }
+    /// @brief  Indicates if each enqueued event is published once, in
+    ///         order, by the flush that takes it from the queue: no routes,
+    ///         coalescing, aggregation or flight recorder are configured
+    bool WritesEachEvent() const {
+        return routes_.empty() && !coalesce_ && !recorder_ &&
+               !aggregate_.load(std::memory_order_relaxed);
+    }
+    /// @brief  Total number of events folded into metrics
+    auto Aggregated() const {
+        return events_aggregated_.load(std::memory_order_relaxed);
+    }
     auto Received() const {
         return events_received_.load(std::memory_order_relaxed);
     }
     auto Published() const {
         return events_published_.load(std::memory_order_relaxed);
     }
+    /// @brief  Total number of events folded into a preceding event
+    auto Coalesced() const {
+        return events_coalesced_.load(std::memory_order_relaxed);
+    }
     /// @brief  Deleted
     Manager& operator=(Manager const&) = delete;
     /// @brief  Deleted
     Manager& operator=(Manager&&) = delete;
 
 private:
+    /// @brief  Stream the oldest queued event
+    /// @return False if the queue was empty
+    bool PublishNext();
+    /// @brief  Indicates if enqueued events take the budgeted path: while a
+    ///         budget is set, or queued events are still charged to one
+    bool Charging() const noexcept {
+        return budget_.load(std::memory_order_relaxed) != 0 ||
+               bytes_queued_.load(std::memory_order_relaxed) != 0;
+    }
+    /// @brief  Enqueue the event, charging its footprint to the budget and
+    ///         dropping the oldest events while the budget is exceeded
+    /// @param  event   Enqueue the log event.
+    void EnqueueBudgeted(EventRef&& event);
+    /// @brief  Enqueue the staged log events with a single claim on the
+    ///         queue. With a memory budget, aggregation, a trace or a
+    ///         flight recorder, each event is enqueued individually.
+    /// @param  staged  The log events to enqueue. They are moved from.
+    template<typename Staged>
+    void EnqueueStaged(std::span<Staged> staged) {
+        if(staged.empty()) return;
+        if(Charging() ||
+           aggregate_.load(std::memory_order_relaxed) ||
+           trace_.load(std::memory_order_relaxed) ||
+           trigger_.load(std::memory_order_relaxed) != no_trigger) {
+            for(auto& event : staged) Enqueue(std::move(Unwrap(event)));
+            return;
+        }
+        queue_->EnqueueBatch(staged.begin(), staged.end());
+        events_received_ += staged.size();
+    }
+    static EventRef& Unwrap(EventRef& event) noexcept { return event; }
+    static EventRef& Unwrap(Wrapper& wrapper) noexcept { return wrapper.event_; }
+    /// @brief  Return the budget charged for a dequeued event
+    /// @param  wrapper The dequeued event
+    void Release(Wrapper const& wrapper) {
+        if(wrapper.footprint_) bytes_queued_.fetch_sub(wrapper.footprint_, std::memory_order_relaxed);
+    }
+    /// @brief  Write the event in the configured format
+    /// @param  os      Where to write the event
+    /// @param  event   The event to write
+    void Write(std::ostream& os, Event const& event) const;
+    /// @brief  Take the next event from the queue in flight recorder mode,
+    ///         streaming it if it is within the window of a trigger
+    /// @return False if the remaining events are held in the queue
+    bool RecordNext();
+    /// @brief  Stream the event, or fold it into the current run of
+    ///         repeated events
+    /// @param  event   The event to stream
+    void Publish(EventRef&& event);
+    /// @brief  Stream the current run of repeated events, if any
+    void EndRun();
+    /// @brief  Stream a summary of the events aggregated since the last
+    ///         summary
+    void Summarize();
+
+    /// @brief  An event awaiting streaming, along with the run of
+    ///         equivalent events folded into it
+    struct Run {
+        Wrapper first_{};
+        size_t repeats_{};
+        Event::TimePoint repeat_first_{};
+        Event::TimePoint repeat_last_{};
+    };
+    /// @brief  A buffer that a worker formats a chunk of events into
+    struct Chunk {
+        StringSink sink_{};
+        std::ostream os_{&sink_};
+    };
+    /// @brief  Fewer events than this are formatted on the calling thread
+    static constexpr size_t parallel_threshold = 256;
+
+    /// @brief  Stream the event, or add it to the batch to be formatted in
+    ///         parallel. A full batch is formatted and streamed at once, so
+    ///         a long Dump holds a bounded number of events.
+    /// @param  run The event to stream
+    void Emit(Run&& run);
+    /// @brief  Render the event in the configured format
+    /// @param  os  Where to format the event
+    /// @param  run The event to format
+    void Render(std::ostream& os, Run const& run) const;
+    /// @brief  Stream the current run and any batched events
+    void Complete();
+    /// @brief  Format the batched events, in parallel if there are enough,
+    ///         and stream them in order
+    void FormatBatch();
+
     /// @brief  Where to stream events
     std::ostream& os_;
     /// @brief  Where events are queued prior to streaming
@@ -97,5 +513,43 @@ private:
     std::atomic<size_t> events_received_{};
     /// @brief  Total number of events streamed
     std::atomic<size_t> events_published_{};
+    /// @brief  Max memory charged by queued events (0 = unlimited)
+    std::atomic<size_t> budget_{};
+    /// @brief  Memory charged by queued events
+    std::atomic<size_t> bytes_queued_{};
+    /// @brief  Total number of events dropped to honour the budget
+    std::atomic<size_t> events_evicted_{};
+    /// @brief  Total number of events folded into a preceding event
+    std::atomic<size_t> events_coalesced_{};
+    /// @brief  Aggregate events that support it instead of queuing them
+    std::atomic<bool> aggregate_{false};
+    /// @brief  Total number of events folded into metrics
+    std::atomic<size_t> events_aggregated_{};
+    /// @brief  The per-thread aggregates
+    Metrics metrics_{};
+    /// @brief  Where enqueued events are recorded, if anywhere
+    std::atomic<TraceRecorder*> trace_{};
+    /// @brief  Where published events are written in columns, if anywhere
+    ColumnarSink* columnar_{};
+    /// @brief  How events are written
+    Format format_{Format::Text};
+    /// @brief  Coalesce repeated events when streaming
+    bool coalesce_{false};
+    /// @brief  Total number of flight recorder triggers
+    std::atomic<size_t> triggers_{};
+    /// @brief  Events at or above this Severity are flight recorder triggers
+    std::atomic<unsigned> trigger_{no_trigger};
+    /// @brief  Set when in flight recorder mode
+    std::unique_ptr<Recorder> recorder_{};
+    /// @brief  Sinks that take matching events from the manager's stream
+    std::vector<std::unique_ptr<Route>> routes_{};
+    /// @brief  The current run of repeated events
+    Run run_{};
+    /// @brief  Formats events in parallel, if configured
+    std::unique_ptr<FormatPool> pool_{};
+    /// @brief  One formatting buffer per worker, plus the calling thread
+    std::vector<std::unique_ptr<Chunk>> chunks_{};
+    /// @brief  Events awaiting parallel formatting
+    std::vector<Run> batch_{};
 };
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <Metrics.h>
+#include <Utility.h>
+
+namespace pentifica::log {
+void
+Histogram::Merge(Histogram const& other) noexcept {
+    for(size_t i = 0; i < bucket_count; ++i) {
+        buckets_[i] += other.buckets_[i];
+        negative_[i] += other.negative_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+double
+Histogram::Percentile(double fraction) const noexcept {
+    if(count_ == 0) return 0;
+    auto const rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(count_)));
+    size_t seen{};
+    //  Negative buckets, from the largest magnitude down to (-1, 0)
+    for(size_t bucket = bucket_count; bucket-- > 0;) {
+        seen += negative_[bucket];
+        if(seen >= rank && seen > 0) {
+            auto const upper = bucket == 0 ? 0.0 : -std::ldexp(1.0, static_cast<int>(bucket) - 1);
+            return std::clamp(upper, min_, max_);
+        }
+    }
+    for(size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        seen += buckets_[bucket];
+        if(seen >= rank && seen > 0) {
+            auto const upper = bucket == 0 ? 1.0 : std::ldexp(1.0, static_cast<int>(bucket));
+            return std::clamp(upper, min_, max_);
+        }
+    }
+    return max_;
+}
+
+void
+MetricSeries::Merge(MetricSeries const& other) {
+    name_ = other.name_;
+    fields_ = other.fields_;
+    count_ += other.count_;
+    histograms_.resize(std::max(histograms_.size(), other.histograms_.size()));
+    for(size_t i = 0; i < other.histograms_.size(); ++i) histograms_[i].Merge(other.histograms_[i]);
+}
+
+void
+MetricSeries::Reset() noexcept {
+    count_ = 0;
+    for(auto& histogram : histograms_) histogram.Reset();
+}
+
+void
+MetricShard::Fold(std::type_info const& type,
+                  std::string_view name,
+                  std::span<std::string_view const> fields,
+                  std::span<double const> values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = series_[std::type_index(type)];
+    if(series.histograms_.empty()) {
+        series.name_ = name;
+        series.fields_ = fields;
+        series.histograms_.resize(values.size());
+    }
+    ++series.count_;
+    for(size_t i = 0; i < values.size(); ++i) series.histograms_[i].Add(values[i]);
+}
+
+void
+MetricSummary::Log(std::ostream& os) const {
+    FieldWriter writer{os};
+    writer.Write("metrics ").Write(series_.name_)
+        .Write(" count=").Write(series_.count_)
+        .Write(" interval_ms=").Write(std::chrono::duration_cast<std::chrono::milliseconds>(interval_).count());
+    for(size_t i = 0; i < series_.histograms_.size(); ++i) {
+        auto const& histogram = series_.histograms_[i];
+        if(histogram.Count() == 0) continue;
+        writer.Write(' ').Write(series_.fields_[i])
+            .Write("{mean=").Write(histogram.Mean())
+            .Write(" min=").Write(histogram.Min())
+            .Write(" p50=").Write(histogram.Percentile(0.5))
+            .Write(" p99=").Write(histogram.Percentile(0.99))
+            .Write(" max=").Write(histogram.Max())
+            .Write('}');
+    }
+}
+
+void
+MetricSummary::LogJson(std::ostream& os) const {
+    FieldWriter writer{os};
+    writer.Write(",\"metric\":").WriteJson(series_.name_)
+        .Write(",\"count\":").WriteJson(series_.count_)
+        .Write(",\"interval_ms\":").WriteJson(std::chrono::duration_cast<std::chrono::milliseconds>(interval_).count());
+    for(size_t i = 0; i < series_.histograms_.size(); ++i) {
+        auto const& histogram = series_.histograms_[i];
+        if(histogram.Count() == 0) continue;
+        writer.Write(',').WriteJson(series_.fields_[i])
+            .Write(":{\"mean\":").WriteJson(histogram.Mean())
+            .Write(",\"min\":").WriteJson(histogram.Min())
+            .Write(",\"p50\":").WriteJson(histogram.Percentile(0.5))
+            .Write(",\"p99\":").WriteJson(histogram.Percentile(0.99))
+            .Write(",\"max\":").WriteJson(histogram.Max())
+            .Write('}');
+    }
+}
+
+Metrics::Metrics() : alive_{std::make_shared<char>()} {}
+
+MetricShard&
+Metrics::Shard() {
+    struct Entry {
+        Metrics const* owner_;
+        std::weak_ptr<void> alive_;
+        std::shared_ptr<MetricShard> shard_;
+    };
+    thread_local std::vector<Entry> cache;
+    for(auto entry = cache.begin(); entry != cache.end();) {
+        //  Checked first, as a new Metrics may reuse the address
+        if(entry->alive_.expired()) {
+            entry = cache.erase(entry);
+            continue;
+        }
+        if(entry->owner_ == this) return *entry->shard_;
+        ++entry;
+    }
+
+    auto shard = std::make_shared<MetricShard>();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.push_back(shard);
+    }
+    cache.push_back(Entry{this, alive_, shard});
+    return *shard;
+}
+
+void
+Metrics::Merge() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto const& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex_);
+        for(auto& [type, series] : shard->series_) {
+            if(series.count_ == 0) continue;
+            totals_[type].Merge(series);
+            series.Reset();
+        }
+    }
+    // Only the Metrics holds the shard of a thread that has exited; its
+    // aggregates were merged above
+    std::erase_if(shards_, [](auto const& shard) { return shard.use_count() == 1; });
+}
+}
\ No newline at end of file
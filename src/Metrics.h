@@ -0,0 +1,233 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include <NamedEvent.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace pentifica::log {
+/// @brief  Distribution of the values of a field in power of two buckets,
+///         kept separately for negative values by magnitude. Percentiles are
+///         reported as the upper bound of the bucket holding the percentile,
+///         clamped to the observed range.
+class Histogram {
+public:
+    static constexpr size_t bucket_count = 66;
+    /// @brief  Add a value
+    /// @param  value   The value to add; NaN is ignored
+    void Add(double value) noexcept {
+        if(std::isnan(value)) return;
+        if(value < 0) ++negative_[Bucket(-value)];
+        else ++buckets_[Bucket(value)];
+        ++count_;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    /// @brief  Add the values of another histogram
+    /// @param  other   The histogram to merge
+    void Merge(Histogram const& other) noexcept;
+    /// @brief  Remove all values
+    void Reset() noexcept { *this = Histogram{}; }
+    size_t Count() const noexcept { return count_; }
+    double Sum() const noexcept { return sum_; }
+    double Mean() const noexcept { return count_ ? sum_ / static_cast<double>(count_) : 0; }
+    double Min() const noexcept { return count_ ? min_ : 0; }
+    double Max() const noexcept { return count_ ? max_ : 0; }
+    /// @brief  The value below which the indicated fraction of values fall
+    /// @param  fraction    The fraction of values, e.g. 0.99
+    /// @return The approximate percentile
+    double Percentile(double fraction) const noexcept;
+
+private:
+    /// @brief  Bucket 0 holds magnitudes < 1, bucket b holds [2^(b-1), 2^b)
+    static size_t Bucket(double value) noexcept {
+        if(!(value >= 1)) return 0;
+        if(value >= 0x1p63) return bucket_count - 1;
+        return static_cast<size_t>(std::bit_width(static_cast<std::uint64_t>(value)));
+    }
+
+    std::array<size_t, bucket_count> buckets_{};
+    std::array<size_t, bucket_count> negative_{};
+    size_t count_{};
+    double sum_{};
+    double min_{std::numeric_limits<double>::infinity()};
+    double max_{-std::numeric_limits<double>::infinity()};
+};
+
+/// @brief  The aggregate of the events of one type: the number of events and
+///         a Histogram per field
+struct MetricSeries {
+    std::string_view name_{};
+    std::span<std::string_view const> fields_{};
+    size_t count_{};
+    std::vector<Histogram> histograms_{};
+    /// @brief  Add the aggregate of another series of the same type
+    void Merge(MetricSeries const& other);
+    /// @brief  Reset the counts, keeping the series
+    void Reset() noexcept;
+};
+
+/// @brief  The aggregates folded by one thread for one Manager. Only the
+///         owning thread folds into a shard; the lock is contended only while
+///         the Manager collects the shard.
+class MetricShard {
+public:
+    /// @brief  Fold an event into the series of its type
+    /// @param  type    The type of the event
+    /// @param  name    The name of the series
+    /// @param  fields  The names of the fields
+    /// @param  values  The value of each field; NaN for fields that are not
+    ///                 aggregated
+    void Fold(std::type_info const& type,
+              std::string_view name,
+              std::span<std::string_view const> fields,
+              std::span<double const> values);
+
+private:
+    friend class Metrics;
+    std::mutex mutex_;
+    std::unordered_map<std::type_index, MetricSeries> series_;
+};
+
+/// @brief  Event streamed by a Manager in place of the aggregated events of
+///         one type, summarising them over an interval
+class MetricSummary :
+    public Event
+{
+public:
+    /// @brief  Prepare a summary
+    /// @param  series      The aggregate of the events
+    /// @param  interval    The period the events were aggregated over
+    MetricSummary(MetricSeries series, std::chrono::nanoseconds interval) :
+        Event(Severity::Info), series_{std::move(series)}, interval_{interval} {}
+    MetricSeries const& Series() const noexcept { return series_; }
+
+protected:
+    void Log(std::ostream& os) const override;
+    void LogJson(std::ostream& os) const override;
+
+private:
+    MetricSeries series_;
+    std::chrono::nanoseconds interval_;
+};
+
+/// @brief  Per-thread aggregation of events for one Manager. Threads fold
+///         events into their own shard, found through a thread local cache,
+///         and the shards are collected into summaries when the Manager
+///         flushes.
+class Metrics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Metrics();
+    /// @brief Deleted
+    Metrics(Metrics const&) = delete;
+    /// @brief Deleted
+    Metrics& operator=(Metrics const&) = delete;
+    /// @brief  The calling thread's shard, created on first use. Cache entries
+    ///         of destroyed Metrics are dropped as the cache is scanned.
+    MetricShard& Shard();
+    /// @brief  The number of shards: one per live thread that has folded
+    ///         events, plus those of exited threads not yet collected
+    size_t ShardCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shards_.size();
+    }
+    /// @brief  Collect and reset the shards
+    /// @param  emit    Called with a MetricSummary for each type folded
+    ///                 since the last collection
+    template<typename Emitter>
+    void Collect(Emitter&& emit) {
+        auto const now = Clock::now();
+        auto const interval = now - since_;
+        since_ = now;
+        Merge();
+        for(auto& [type, series] : totals_) {
+            if(series.count_ == 0) continue;
+            emit(Factory<MetricSummary>::Create(series, interval));
+            series.Reset();
+        }
+    }
+
+private:
+    /// @brief  Merge the shards into the totals, resetting the shards and
+    ///         dropping those of threads that have exited
+    void Merge();
+
+    /// @brief  Expires when the Metrics is destroyed, so the thread local
+    ///         caches can tell live entries from stale ones
+    std::shared_ptr<void> const alive_;
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<MetricShard>> shards_;
+    std::unordered_map<std::type_index, MetricSeries> totals_;
+    Clock::time_point since_{Clock::now()};
+};
+
+/// @brief  A NamedEvent that, when its Manager aggregates metrics, is folded
+///         into per field histograms instead of being queued. Arithmetic
+///         fields are aggregated; other fields are ignored. The Manager
+///         streams one MetricSummary per type per flush, e.g.
+///             using FillLatency = MetricEvent<"fill", FieldNames<"venue", "latency_us">,
+///                                             char const*, double>;
+/// @tparam Name        The name of the series
+/// @tparam Names       The FieldNames of the fields
+/// @tparam ...Fields   Parameter pack of fields the event will capture
+template<FixedString Name, typename Names, typename... Fields>
+class MetricEvent :
+    public NamedEvent<Names, Fields...>
+{
+    using Base = NamedEvent<Names, Fields...>;
+
+public:
+    using Base::Base;
+    bool Fold(Metrics& metrics) const override {
+        std::array<double, sizeof...(Fields)> values;
+        Values(std::make_index_sequence<sizeof...(Fields)>{}, values);
+        metrics.Shard().Fold(typeid(*this), Name.View(), Names::names, values);
+        return true;
+    }
+
+private:
+    template<size_t... Is>
+    void Values(std::index_sequence<Is...>, std::array<double, sizeof...(Fields)>& values) const {
+        ((values[Is] = Value(std::get<Is>(this->Data()))), ...);
+    }
+    template<typename T>
+    static double Value(T const& value) noexcept {
+        if constexpr(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) return static_cast<double>(value);
+        else return std::numeric_limits<double>::quiet_NaN();
+    }
+};
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include <GenericEvent.h>
+#include <Utility.h>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+namespace pentifica::log {
+/// @brief  A string literal usable as a template argument
+/// @tparam N   The size of the literal, including the terminating null
+template<size_t N>
+struct FixedString {
+    char value_[N];
+    constexpr FixedString(char const (&text)[N]) { std::copy_n(text, N, value_); }
+    constexpr std::string_view View() const { return {value_, N - 1}; }
+};
+/// @brief  The compile time names of the fields of a NamedEvent, e.g.
+///             FieldNames<"price", "quantity">
+/// @tparam ...Names    The field names
+template<FixedString... Names>
+struct FieldNames {
+    static constexpr size_t size = sizeof...(Names);
+    static constexpr std::array<std::string_view, size> names{Names.View()...};
+};
+/// @brief  A GenericEvent whose fields have compile time names. As text, the
+///         fields are streamed as name=value pairs separated by spaces. As
+///         JSON, each field is a member of the JSON object.
+/// @tparam Names       The FieldNames of the fields
+/// @tparam ...Fields   Parameter pack of fields the event will capture
+template<typename Names, typename... Fields>
+class NamedEvent :
+    public GenericEvent<Fields...>
+{
+    static_assert(Names::size == sizeof...(Fields), "One name is required per field");
+    using Base = GenericEvent<Fields...>;
+
+public:
+    using Base::Base;
+    /// @brief  Streams the fields as name=value pairs
+    /// @param  os  Where to stream the fields
+    void Log(std::ostream& os) const override {
+        FieldWriter writer{os};
+        Render(std::make_index_sequence<sizeof...(Fields)>{}, [&writer](size_t index, auto const& value) {
+            if(index) writer.Write(' ');
+            writer.Write(Names::names[index]).Write('=').Write(value);
+        });
+    }
+
+protected:
+    /// @brief  Streams the fields as JSON members
+    /// @param  os  Where to stream the fields
+    void LogJson(std::ostream& os) const override {
+        FieldWriter writer{os};
+        Render(std::make_index_sequence<sizeof...(Fields)>{}, [&writer](size_t index, auto const& value) {
+            writer.Write(",\"").Write(Names::names[index]).Write("\":").WriteJson(value);
+        });
+    }
+
+private:
+    template<size_t... Is, typename Renderer>
+    void Render(std::index_sequence<Is...>, Renderer&& render) const {
+        (render(Is, std::get<Is>(this->Data())), ...);
+    }
+};
+}
\ No newline at end of file
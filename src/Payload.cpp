@@ -0,0 +1,56 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include    <Payload.h>
+#include    <Utility.h>
+
+#include    <algorithm>
+
+namespace pentifica::log {
+std::ostream& operator<<(std::ostream& os, Payload const& payload) {
+    FieldWriter writer{os};
+    writer.Write("payload(").Write(payload.Size()).Write(" bytes");
+    if(payload.Dropped()) {
+        writer.Write(" dropped: budget exceeded)");
+        return os;
+    }
+    writer.Write(')');
+
+    auto const bytes = payload.Bytes();
+    auto const limit = std::min(bytes.size(), Payload::render_limit_.load(Payload::memory_order));
+    for(size_t offset = 0; offset < limit; offset += Payload::line_width) {
+        auto const count = std::min(Payload::line_width, limit - offset);
+        writer.Write("\n    ").WriteHex(offset, 4).Write(' ');
+        for(size_t i = 0; i < Payload::line_width; ++i) {
+            if(i < count) writer.Write(' ').WriteHex(std::to_integer<unsigned>(bytes[offset + i]), 2);
+            else writer.Write("   ");
+        }
+        writer.Write("  ");
+        for(size_t i = 0; i < count; ++i) {
+            auto const c = std::to_integer<char>(bytes[offset + i]);
+            writer.Write(c >= 0x20 && c < 0x7f ? c : '.');
+        }
+    }
+    if(limit < bytes.size()) {
+        writer.Write("\n    ... ").Write(bytes.size() - limit).Write(" bytes not shown");
+    }
+    return os;
+}
+}
\ No newline at end of file
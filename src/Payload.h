@@ -0,0 +1,117 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <SizeClassPool.h>
+
+#include    <atomic>
+#include    <cstddef>
+#include    <iostream>
+#include    <limits>
+#include    <memory>
+#include    <span>
+
+namespace pentifica::log {
+/// @brief  A field type for capturing large binary buffers (e.g. packets)
+///         without copying them. The payload shares ownership of the caller's
+///         buffer, which is released when the owning event is reclaimed after
+///         being streamed. Streaming renders a bounded hex/ASCII dump.
+///
+///         The total number of bytes held by payloads is capped by a
+///         configurable budget. A payload that would exceed the budget does
+///         not retain its buffer; only its size is recorded and reported.
+class Payload {
+public:
+    using Buffer = std::shared_ptr<std::byte const[]>;
+    /// @brief  Number of bytes rendered per dump line
+    static constexpr size_t line_width = 16;
+
+    Payload() = default;
+    /// @brief  Share ownership of the indicated buffer
+    /// @param  buffer  The captured bytes
+    /// @param  size    The number of bytes in the buffer
+    Payload(Buffer buffer, size_t size) : size_{size} {
+        if(!buffer || size == 0) return;
+        auto const held = in_use_.fetch_add(size, memory_order) + size;
+        if(held > budget_.load(memory_order)) {
+            in_use_.fetch_sub(size, memory_order);
+            dropped_.fetch_add(1, memory_order);
+            return;
+        }
+        lease_ = std::allocate_shared<Lease const>(SizeClassAllocator<Lease const>{}, std::move(buffer), size);
+    }
+    Payload(Payload const&) = default;
+    Payload(Payload&&) = default;
+    ~Payload() = default;
+    Payload& operator=(Payload const&) = default;
+    Payload& operator=(Payload&&) = default;
+    /// @brief  The size of the captured buffer
+    /// @return The size of the captured buffer, even if it was not retained
+    size_t Size() const noexcept { return size_; }
+    /// @brief  Indicates if the buffer was not retained due to the budget
+    /// @return True if the buffer was not retained
+    bool Dropped() const noexcept { return size_ != 0 && !lease_; }
+    /// @brief  The memory held by the payload
+    /// @return The number of retained bytes
+    size_t Footprint() const noexcept { return lease_ ? lease_->size_ : 0; }
+    /// @brief  The retained bytes
+    /// @return The retained bytes, empty if the buffer was dropped
+    std::span<std::byte const> Bytes() const noexcept {
+        if(!lease_) return {};
+        return {lease_->buffer_.get(), lease_->size_};
+    }
+    /// @brief  Set the max number of bytes all payloads may hold at once
+    /// @param  bytes   The budget
+    static void SetBudget(size_t bytes) { budget_.store(bytes, memory_order); }
+    /// @brief  The max number of bytes all payloads may hold at once
+    static auto Budget() { return budget_.load(memory_order); }
+    /// @brief  The number of bytes currently held by all payloads
+    static auto InUse() { return in_use_.load(memory_order); }
+    /// @brief  The number of payloads not retained due to the budget
+    static auto DroppedCount() { return dropped_.load(memory_order); }
+    /// @brief  Set the max number of bytes rendered per payload
+    /// @param  bytes   The render limit
+    static void SetRenderLimit(size_t bytes) { render_limit_.store(bytes, memory_order); }
+    /// @brief  Renders a bounded hex/ASCII dump of the payload
+    /// @param  os      Where to render the payload
+    /// @param  payload The payload to render
+    /// @return The supplied stream
+    friend std::ostream& operator<<(std::ostream& os, Payload const& payload);
+
+private:
+    static constexpr auto memory_order = std::memory_order_relaxed;
+    /// @brief  Holds the buffer and its share of the budget. Allocated with
+    ///         its reference counts in one SizeClassPool block, so retaining
+    ///         a buffer does not allocate from the heap.
+    struct Lease {
+        Buffer buffer_;
+        size_t size_;
+        Lease(Buffer buffer, size_t size) : buffer_{std::move(buffer)}, size_{size} {}
+        ~Lease() { in_use_.fetch_sub(size_, memory_order); }
+    };
+
+    std::shared_ptr<Lease const> lease_{};
+    size_t size_{};
+
+    inline static std::atomic<size_t> budget_{std::numeric_limits<size_t>::max()};
+    inline static std::atomic<size_t> in_use_{};
+    inline static std::atomic<size_t> dropped_{};
+    inline static std::atomic<size_t> render_limit_{256};
+};
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <Prewarm.h>
+
+#include <vector>
+#include <mutex>
+
+namespace pentifica::log {
+namespace {
+    /// @brief  Registration may happen during static initialization, so the
+    ///         registry is created on first use.
+    struct Tasks {
+        std::mutex mutex_;
+        std::vector<PrewarmRegistry::Task> tasks_;
+    };
+
+    Tasks& GetTasks() {
+        static Tasks tasks;
+        return tasks;
+    }
+}
+
+void
+PrewarmRegistry::Register(Task task) {
+    auto& tasks = GetTasks();
+    std::lock_guard<std::mutex> lock(tasks.mutex_);
+    tasks.tasks_.push_back(std::move(task));
+}
+
+bool
+PrewarmRegistry::Run(bool lock) {
+    auto& tasks = GetTasks();
+    std::lock_guard<std::mutex> guard(tasks.mutex_);
+    bool locked{true};
+    for(auto& task : tasks.tasks_) locked &= task(lock);
+    return locked;
+}
+}
\ No newline at end of file
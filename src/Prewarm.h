@@ -0,0 +1,73 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <Factory.h>
+#include    <Manager.h>
+
+#include    <functional>
+
+namespace pentifica::log {
+/// @brief  Collects the work needed to prepare event pools before the first
+///         events are created, so that all of it can be done up front by a
+///         single call to Prewarm.
+class PrewarmRegistry {
+public:
+    /// @brief  Prepares a pool; returns false if its memory could not be
+    ///         locked
+    using Task = std::function<bool(bool lock)>;
+    /// @brief This class contains only static methods
+    ~PrewarmRegistry() = delete;
+    /// @brief  Add a task to be run by Prewarm
+    /// @param  task    The task to add
+    static void Register(Task task);
+    /// @brief  Run all registered tasks
+    /// @param  lock    Lock the prepared memory if true
+    /// @return False if any memory could not be locked
+    static bool Run(bool lock);
+};
+/// @brief  Declares the initial capacity of the Factory for an event type,
+///         e.g. at namespace scope:
+///             PrewarmCapacity<OrderEvent> const order_prewarm{512};
+/// @tparam Product The Event derived type
+template<typename Product>
+struct PrewarmCapacity {
+    /// @brief  Register the Factory for Product to be prewarmed
+    /// @param  capacity    The initial capacity of the Factory
+    explicit PrewarmCapacity(size_t capacity) {
+        PrewarmRegistry::Register([capacity](bool lock) {
+            return Factory<Product>::Prewarm(capacity, lock);
+        });
+    }
+};
+/// @brief  Allocate and touch the pools of all event types that declared an
+///         initial capacity, optionally locking them into memory.
+/// @param  lock    Lock the memory if true
+/// @return False if any memory could not be locked
+inline bool Prewarm(bool lock = false) { return PrewarmRegistry::Run(lock); }
+/// @brief  Prewarm the declared pools as well as the queues of a Manager
+/// @param  manager The Manager whose queues to prepare
+/// @param  lock    Lock the memory if true
+/// @return False if any memory could not be locked
+inline bool Prewarm(Manager& manager, bool lock = false) {
+    auto locked = PrewarmRegistry::Run(lock);
+    if(lock) locked &= manager.Lock();
+    return locked;
+}
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <Category.h>
+#include    <Factory.h>
+#include    <GenericEvent.h>
+#include    <Manager.h>
+#include    <Severity.h>
+
+#include    <algorithm>
+#include    <atomic>
+#include    <chrono>
+#include    <cstdint>
+
+namespace pentifica::log {
+/// @brief  A lock-free token bucket. Tokens are replenished continuously at
+///         the configured rate, up to the configured burst. Implemented as a
+///         generic cell rate algorithm so the entire state is one atomic.
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+    /// @brief  Prepare a bucket
+    /// @param  rate    Tokens replenished per second (0 = unlimited)
+    /// @param  burst   Max tokens that may be taken at once
+    TokenBucket(double rate, size_t burst) :
+        interval_{rate > 0 ? static_cast<std::int64_t>(1e9 / rate) : 0},
+        tolerance_{interval_ * static_cast<std::int64_t>(burst ? burst : 1)} {}
+    /// @brief  Take a token if one is available
+    /// @param  now The current time
+    /// @return True if a token was taken
+    bool TryAcquire(Clock::time_point now = Clock::now()) noexcept {
+        if(interval_ == 0) return true;
+
+        auto const current = now.time_since_epoch().count();
+        auto arrival = arrival_.load(std::memory_order_relaxed);
+        for(;;) {
+            auto const next = std::max(arrival, current) + interval_;
+            if(next - current > tolerance_) return false;
+            if(arrival_.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) return true;
+        }
+    }
+
+private:
+    std::int64_t const interval_;
+    std::int64_t const tolerance_;
+    /// @brief  Theoretical arrival time of the next token
+    std::atomic<std::int64_t> arrival_{};
+};
+
+/// @brief  Guards a single call site against event floods. Events are first
+///         sampled (1 in N) and then rate limited by a token bucket before the
+///         event is created. Suppressed events are counted over a window that
+///         opens with the first suppressed event and lasts one summary
+///         interval; the summary event is enqueued the first time the call
+///         site is reached after the window closes. Declare one instance per
+///         call site, e.g. as a function local static.
+class CallSite {
+public:
+    using Clock = TokenBucket::Clock;
+    using SummaryEvent = GenericEvent<char const*, char const*, char const*, size_t, char const*>;
+
+    struct Limits {
+        /// @brief  Events admitted per second (0 = unlimited)
+        double rate_{0};
+        /// @brief  Max events admitted at once
+        size_t burst_{1};
+        /// @brief  Admit 1 in every sample_ events (0 or 1 = every event)
+        size_t sample_{1};
+        /// @brief  Minimum time between summaries of suppressed events
+        std::chrono::nanoseconds summary_interval_{std::chrono::seconds(1)};
+    };
+
+    /// @brief  Prepare a call site
+    /// @param  name    Identifies the call site in summary events. Must
+    ///                 outlive the call site.
+    /// @param  limits  The sampling and rate limits
+    CallSite(char const* name, Limits limits) :
+        name_{name},
+        limits_{limits},
+        bucket_{limits.rate_, limits.burst_} {}
+    /// @brief Deleted
+    CallSite(CallSite const&) = delete;
+    /// @brief Deleted
+    CallSite(CallSite&&) = delete;
+    ~CallSite() = default;
+    /// @brief Deleted
+    CallSite& operator=(CallSite const&) = delete;
+    /// @brief Deleted
+    CallSite& operator=(CallSite&&) = delete;
+    /// @brief  Determine if the next event from the call site should be
+    ///         logged. Suppressed events are counted.
+    /// @param  now The current time
+    /// @return True if the event should be logged
+    bool Admit(Clock::time_point now = Clock::now()) noexcept {
+        auto const sampled = limits_.sample_ <= 1 ||
+            seen_.fetch_add(1, std::memory_order_relaxed) % limits_.sample_ == 0;
+        if(sampled && bucket_.TryAcquire(now)) return true;
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    /// @brief  Create and enqueue an event if its category is enabled and the
+    ///         call site admits it. If a summary is due, a summary of the
+    ///         suppressed events is enqueued first.
+    /// @tparam Product     The Event derived type to create
+    /// @tparam ...Ts       The parameter pack definition for the Product ctor
+    /// @param  manager     Where to enqueue the events
+    /// @param  severity    The severity of the event (and any summary)
+    /// @param  ...params   The parameter pack values
+    /// @return True if the event was enqueued
+    template<typename Product, typename... Ts>
+    bool Emit(Manager& manager, Severity severity, Ts&&... params) {
+        if(!Categories::Enabled<Product>(severity)) return false;
+
+        auto const now = Clock::now();
+        auto const admitted = Admit(now);
+        Summarize(manager, severity, now);
+        if(!admitted) return false;
+
+        auto event = Factory<Product>::Create(std::forward<Ts>(params)...);
+        event->Reset(severity);
+        manager.Enqueue(std::move(event));
+        return true;
+    }
+    /// @brief  Enqueue a summary of the suppressed events if their window has
+    ///         closed, or open the window if none is open
+    /// @param  manager     Where to enqueue the summary
+    /// @param  severity    The severity of the summary
+    /// @param  now         The current time
+    void Summarize(Manager& manager, Severity severity, Clock::time_point now = Clock::now()) {
+        if(suppressed_.load(std::memory_order_relaxed) == 0) return;
+
+        auto const current = now.time_since_epoch().count();
+        auto due = next_summary_.load(std::memory_order_relaxed);
+        if(due == 0) {
+            next_summary_.compare_exchange_strong(due, current + limits_.summary_interval_.count(),
+                                                  std::memory_order_relaxed);
+            return;
+        }
+        if(current < due) return;
+        //  Close the window; the next suppressed event opens another
+        if(!next_summary_.compare_exchange_strong(due, 0, std::memory_order_relaxed)) return;
+
+        auto const count = suppressed_.exchange(0, std::memory_order_relaxed);
+        if(count == 0) return;
+        auto summary = Factory<SummaryEvent>::Create("call site ", name_, ": ", count, " events suppressed");
+        summary->Reset(severity);
+        manager.Enqueue(std::move(summary));
+        summaries_.fetch_add(1, std::memory_order_relaxed);
+    }
+    /// @brief  Number of events suppressed since the last summary
+    auto Suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+    /// @brief  Number of summaries enqueued
+    auto Summaries() const { return summaries_.load(std::memory_order_relaxed); }
+
+private:
+    char const* const name_;
+    Limits const limits_;
+    TokenBucket bucket_;
+    std::atomic<size_t> seen_{};
+    std::atomic<size_t> suppressed_{};
+    std::atomic<size_t> summaries_{};
+    /// @brief  When the open window closes, or 0 if none is open
+    std::atomic<Clock::rep> next_summary_{};
+};
+}
\ No newline at end of file
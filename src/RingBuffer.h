@@ -23,6 +23,9 @@
 #include    <mutex>
 #include    <iostream>
 #include    <optional>
+#include    <utility>
+
+#include    <sys/mman.h>
 
 namespace pentifica::log {
 /// @brief Provides a circular enque/deque mechanism for log events. If events
@@ -31,24 +34,30 @@ namespace pentifica::log {
 ///                     support an empty ctor and be std::move'able
 /// @tparam Lockable    Must conform to the BasicLockableType
 ///                     (default = std::mutex)
-template<typename Element, typename Lockable = std::mutex>
+/// @tparam Allocator   Allocates the storage of the buffer
+///                     (default = std::allocator<Element>)
+template<typename Element, typename Lockable = std::mutex, typename Allocator = std::allocator<Element>>
 class RingBuffer {
-    using Cache = std::vector<Element>;
+    using Cache = std::vector<Element, Allocator>;
 
 public:
     /// @brief Initialize
-    /// @param capacity The capacity of the buffer. 
-    explicit RingBuffer(size_t capacity) : cache_(capacity) {}
+    /// @param capacity     The capacity of the buffer. 
+    /// @param allocator    Allocates the storage of the buffer
+    explicit RingBuffer(size_t capacity, Allocator const& allocator = Allocator()) :
+        cache_(capacity, allocator) {}
     /// @brief Deleted
     RingBuffer(RingBuffer const&) = delete;
-    /// @brief  Move the indicated buffer into the new buffer
+    /// @brief  Move the indicated buffer into the new buffer. The moved
+    ///         from buffer is left empty with the same capacity.
     /// @param buffer 
-    RingBuffer(RingBuffer&& buffer) {
-        next_read_ = buffer.next_read_;
-        next_write_ = buffer.next_write_;
-        cache_ = buffer.cache_;
-        buffer.next_read_ = 0;
-        buffer.next_write_ = 0;
+    RingBuffer(RingBuffer&& buffer) : cache_(buffer.cache_.get_allocator()) {
+        std::lock_guard<Lockable> lock{buffer.mutex_};
+        next_read_ = std::exchange(buffer.next_read_, 0);
+        next_write_ = std::exchange(buffer.next_write_, 0);
+        overruns_ = std::exchange(buffer.overruns_, 0);
+        cache_ = std::move(buffer.cache_);
+        buffer.cache_ = Cache(cache_.size(), cache_.get_allocator());
     }
     ~RingBuffer() = default;
     /// @brief  Enbuffer the specified event. If the cache is full, the event
@@ -61,7 +70,45 @@ public:
         cache_[write] = std::move(event);
 
         ++next_write_;
-        next_read_ += (next_write_ - next_read_) > cache_.size();
+        auto const overrun = (next_write_ - next_read_) > cache_.size();
+        next_read_ += overrun;
+        overruns_ += overrun;
+    }
+    /// @brief  Enbuffer the indicated events, in order, under a single lock.
+    ///         If the cache is full, the events will replace the oldest
+    ///         events in the buffer.
+    /// @param first    The first event to buffer
+    /// @param last     One past the last event to buffer
+    template<typename Iterator>
+    void EnqueueBatch(Iterator first, Iterator last) noexcept {
+        std::lock_guard<Lockable> lock{mutex_};
+
+        for(; first != last; ++first) {
+            cache_[next_write_ % cache_.size()] = Element(std::move(*first));
+            ++next_write_;
+        }
+        if(next_write_ - next_read_ > cache_.size()) {
+            overruns_ += next_write_ - next_read_ - cache_.size();
+            next_read_ = next_write_ - cache_.size();
+        }
+    }
+    /// @brief  Enbuffer the specified event. If the cache is full, the event
+    ///         will replace the oldest event in the buffer, which is returned.
+    /// @param event    The event to buffer
+    /// @return The event that was replaced, if any
+    std::optional<Element> EnqueueEvict(Element event) noexcept {
+        std::lock_guard<Lockable> lock{mutex_};
+
+        std::optional<Element> evicted{};
+        auto const write = next_write_ % cache_.size();
+        if(next_write_ - next_read_ == cache_.size()) {
+            evicted.emplace(std::move(cache_[write]));
+            ++next_read_;
+            ++overruns_;
+        }
+        cache_[write] = std::move(event);
+        ++next_write_;
+        return evicted;
     }
     /// @brief  Return the oldest event on the buffer.
     /// @return The oldest event on the buffer.
@@ -75,15 +122,77 @@ public:
 
         return std::optional<Element>(std::move(cache_[read]));
     }
+    /// @brief  Locks the storage of the buffer into memory. The storage is
+    ///         touched when the buffer is constructed, so only locking is
+    ///         required to avoid page faults.
+    /// @return True if the storage was locked
+    bool Lock() const noexcept {
+        std::lock_guard<Lockable> lock{mutex_};
+        return mlock(cache_.data(), cache_.size() * sizeof(Element)) == 0;
+    }
+    /// @brief  Visit the buffered elements, oldest first, without locking or
+    ///         dequeuing them. Only intended for use when the process is
+    ///         crashing and the lock may never be released.
+    /// @param  visit   Called with each buffered element
+    template<typename Visitor>
+    void VisitUnlocked(Visitor&& visit) const noexcept {
+        auto const size = cache_.size();
+        auto const write = next_write_;
+        auto read = next_read_;
+        if(size == 0 || write < read) return;
+        if(write - read > size) read = write - size;
+        for(; read != write; ++read) visit(cache_[read % size]);
+    }
+    /// @brief  Change the capacity of the buffer, migrating the buffered
+    ///         events in order. Callers enqueuing or dequeuing wait while the
+    ///         events are migrated. If the new capacity is less than the
+    ///         number of buffered events, the oldest events are dropped and
+    ///         counted as overruns. A new cache is allocated and the old one
+    ///         released; with an ArenaAllocator the old cache's memory stays
+    ///         in the arena until the arena is destroyed, so resize such
+    ///         buffers sparingly.
+    /// @param capacity The new capacity of the buffer; must not be 0
+    /// @param dropped  Called with each event dropped to fit the capacity
+    template<typename Visitor>
+    void Resize(size_t capacity, Visitor&& dropped) {
+        if(capacity == 0) return;
+        Cache resized(capacity, cache_.get_allocator());
+
+        std::lock_guard<Lockable> lock{mutex_};
+        auto const size = cache_.size();
+        for(; next_write_ - next_read_ > capacity; ++next_read_, ++overruns_) {
+            dropped(std::move(cache_[next_read_ % size]));
+        }
+        auto const length = next_write_ - next_read_;
+        for(size_t i = 0; i < length; ++i) {
+            resized[i] = std::move(cache_[(next_read_ + i) % size]);
+        }
+        cache_.swap(resized);
+        next_read_ = 0;
+        next_write_ = length;
+    }
+    /// @brief  Change the capacity of the buffer, migrating the buffered
+    ///         events in order (see above)
+    /// @param capacity The new capacity of the buffer; must not be 0
+    void Resize(size_t capacity) { Resize(capacity, [](Element&&) noexcept {}); }
     /// @brief  Returns the configured capacity of the buffer.
     /// @return The configured capacity of the buffer.
-    auto Capacity() const noexcept { return cache_.size(); }
+    auto Capacity() const noexcept {
+        std::lock_guard<Lockable> lock{mutex_};
+        return cache_.size();
+    }
     /// @brief  Returns the number of events currently bufferd.
     /// @return The number of events currently bufferd.
     auto Length() const noexcept {
         std::lock_guard<Lockable> lock{mutex_};
         return next_write_ - next_read_;
     }
+    /// @brief  Returns the number of events replaced before being dequeued.
+    /// @return The number of events replaced before being dequeued.
+    auto Overruns() const noexcept {
+        std::lock_guard<Lockable> lock{mutex_};
+        return overruns_;
+    }
     /// @brief  Indicates if the the buffer is empty
     /// @return Returns true if the buffer is empty
     auto Empty() const { return Length() == 0; }
@@ -101,11 +210,12 @@ public:
     //
     RingBuffer& operator=(RingBuffer&& buffer) {
         if(&buffer != this) {
-            next_read_ = buffer.next_read_;
-            next_write_ = buffer.next_write_;
-            cache_ = buffer.cache_;
-            buffer.next_read_ = 0;
-            buffer.next_write_ = 0;
+            std::scoped_lock lock{mutex_, buffer.mutex_};
+            next_read_ = std::exchange(buffer.next_read_, 0);
+            next_write_ = std::exchange(buffer.next_write_, 0);
+            overruns_ = std::exchange(buffer.overruns_, 0);
+            cache_ = std::move(buffer.cache_);
+            buffer.cache_ = Cache(cache_.size(), cache_.get_allocator());
         }
         return *this;
     }
@@ -113,6 +223,7 @@ public:
 private:
     size_t next_read_{0};
     size_t next_write_{0};
+    size_t overruns_{0};
     Cache cache_;
     mutable Lockable mutex_;
 };
@@ -0,0 +1,108 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <SizeClassPool.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/mman.h>
+
+namespace pentifica::log {
+SizeClassPool::~SizeClassPool() {
+    for(auto& size_class : classes_) {
+        for(auto slab : size_class.slabs_) std::free(slab);
+    }
+}
+
+void
+SizeClassPool::Grow(SizeClass& size_class, size_t block_size, size_t count) {
+    auto const blocks = std::max(count, slab_size / block_size);
+    auto const slab = static_cast<std::byte*>(std::aligned_alloc(min_block, blocks * block_size));
+    if(slab == nullptr) throw std::bad_alloc();
+    size_class.slabs_.push_back(slab);
+
+    for(size_t i = blocks; i-- > 0;) {
+        auto block = reinterpret_cast<Block*>(slab + i * block_size);
+        block->next_ = size_class.free_;
+        size_class.free_ = block;
+    }
+    size_class.capacity_ += blocks;
+    size_class.available_ += blocks;
+}
+
+void*
+SizeClassPool::Allocate(size_t size) {
+    auto& size_class = classes_[ClassIndex(size)];
+    std::lock_guard<std::mutex> lock(size_class.mutex_);
+    if(size_class.free_ == nullptr) Grow(size_class, BlockSize(size), 1);
+
+    auto block = size_class.free_;
+    size_class.free_ = block->next_;
+    --size_class.available_;
+    return block;
+}
+
+void
+SizeClassPool::Deallocate(void* memory, size_t size) noexcept {
+    auto& size_class = classes_[ClassIndex(size)];
+    auto block = static_cast<Block*>(memory);
+    std::lock_guard<std::mutex> lock(size_class.mutex_);
+    block->next_ = size_class.free_;
+    size_class.free_ = block;
+    ++size_class.available_;
+}
+
+bool
+SizeClassPool::Reserve(size_t size, size_t count, bool lock) {
+    auto const block_size = BlockSize(size);
+    auto& size_class = classes_[ClassIndex(size)];
+    std::lock_guard<std::mutex> guard(size_class.mutex_);
+    if(size_class.available_ < count) Grow(size_class, block_size, count - size_class.available_);
+
+    bool locked{true};
+    for(auto block = size_class.free_; block != nullptr; block = block->next_) {
+        auto const bytes = reinterpret_cast<std::byte*>(block);
+        std::memset(bytes + sizeof(Block), 0, block_size - sizeof(Block));
+        if(lock) locked &= mlock(block, block_size) == 0;
+    }
+    return locked;
+}
+
+size_t
+SizeClassPool::Capacity(size_t size) const {
+    auto const& size_class = classes_[ClassIndex(size)];
+    std::lock_guard<std::mutex> lock(size_class.mutex_);
+    return size_class.capacity_;
+}
+
+size_t
+SizeClassPool::Available(size_t size) const {
+    auto const& size_class = classes_[ClassIndex(size)];
+    std::lock_guard<std::mutex> lock(size_class.mutex_);
+    return size_class.available_;
+}
+
+SizeClassPool&
+SizeClassPool::Default() {
+    static auto pool = new SizeClassPool;
+    return *pool;
+}
+}
\ No newline at end of file
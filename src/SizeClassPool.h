@@ -0,0 +1,165 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <array>
+#include    <bit>
+#include    <cstddef>
+#include    <cstdlib>
+#include    <mutex>
+#include    <new>
+#include    <vector>
+
+namespace pentifica::log {
+/// @brief  Fixed size blocks shared by every product type, in power of two
+///         size classes from 64 to 2048 bytes. A block released by one type
+///         is reused by any type of the same size class, so idle capacity is
+///         not stranded in per type pools. Blocks are carved from slabs
+///         aligned to min_block; slabs are kept until the pool is destroyed.
+class SizeClassPool {
+public:
+    static constexpr size_t min_block = 64;
+    static constexpr size_t class_count = 6;
+    static constexpr size_t max_block = min_block << (class_count - 1);
+    static constexpr size_t slab_size = 64 * 1024;
+    /// @brief  Indicates if the pool serves allocations of the indicated size
+    ///         and alignment
+    /// @param  size        The number of bytes to allocate
+    /// @param  alignment   The alignment of the allocation
+    /// @return True if a size class serves the allocation
+    static constexpr bool Serves(size_t size, size_t alignment) noexcept {
+        return size > 0 && size <= max_block && alignment <= min_block;
+    }
+    /// @brief  The size of the blocks serving the indicated size
+    /// @param  size    The number of bytes to allocate
+    /// @return The block size
+    static constexpr size_t BlockSize(size_t size) noexcept {
+        return min_block << ClassIndex(size);
+    }
+    SizeClassPool() = default;
+    /// @brief Deleted
+    SizeClassPool(SizeClassPool const&) = delete;
+    /// @brief Deleted
+    SizeClassPool(SizeClassPool&&) = delete;
+    /// @brief  Frees the slabs. Blocks still in use become invalid.
+    ~SizeClassPool();
+    /// @brief Deleted
+    SizeClassPool& operator=(SizeClassPool const&) = delete;
+    /// @brief Deleted
+    SizeClassPool& operator=(SizeClassPool&&) = delete;
+    /// @brief  Allocate a block from the size class serving the size. Thread
+    ///         safe.
+    /// @param  size    The number of bytes to allocate; must be served
+    /// @return The block
+    /// @throws std::bad_alloc if a slab could not be allocated
+    void* Allocate(size_t size);
+    /// @brief  Return a block to its size class. Thread safe.
+    /// @param  memory  The block
+    /// @param  size    The size the block was allocated for
+    void Deallocate(void* memory, size_t size) noexcept;
+    /// @brief  Grows the size class serving the size until at least count
+    ///         blocks are available and touches the available blocks, so they
+    ///         do not take page faults. Optionally locks them into memory.
+    /// @param  size    The size served by the class
+    /// @param  count   The minimum number of available blocks
+    /// @param  lock    Lock the available blocks into memory if true
+    /// @return False if any block could not be locked
+    bool Reserve(size_t size, size_t count, bool lock = false);
+    /// @brief  The number of blocks in the size class serving the size
+    size_t Capacity(size_t size) const;
+    /// @brief  The number of unused blocks in the size class serving the size
+    size_t Available(size_t size) const;
+    /// @brief  The process wide pool used by SizeClassStorage. It is never
+    ///         destroyed, so products may be released during static
+    ///         destruction.
+    static SizeClassPool& Default();
+
+private:
+    static constexpr size_t ClassIndex(size_t size) noexcept {
+        return static_cast<size_t>(std::bit_width((size - 1) / min_block));
+    }
+
+    struct Block {
+        Block* next_;
+    };
+    struct alignas(64) SizeClass {
+        mutable std::mutex mutex_;
+        Block* free_{};
+        size_t capacity_{};
+        size_t available_{};
+        std::vector<void*> slabs_;
+    };
+    /// @brief  Carve a new slab of at least count blocks into the free list.
+    ///         The class must be locked.
+    static void Grow(SizeClass& size_class, size_t block_size, size_t count);
+
+    std::array<SizeClass, class_count> classes_;
+};
+/// @brief  Factory storage policy serving every product type from the
+///         shared SizeClassPool. Products are not cached per type; they are
+///         returned to the pool when released. Products the pool does not
+///         serve are allocated from the heap.
+struct SizeClassStorage {
+    /// @brief  Products are released to the shared pool, not cached per type
+    static constexpr bool shared = true;
+
+    static void* Allocate(size_t size, size_t alignment) {
+        if(SizeClassPool::Serves(size, alignment)) return SizeClassPool::Default().Allocate(size);
+        auto memory = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if(memory == nullptr) throw std::bad_alloc();
+        return memory;
+    }
+    static void Deallocate(void* memory, size_t size, size_t alignment) noexcept {
+        if(SizeClassPool::Serves(size, alignment)) SizeClassPool::Default().Deallocate(memory, size);
+        else std::free(memory);
+    }
+    static bool Reserve(size_t size, size_t alignment, size_t count, bool lock) {
+        if(!SizeClassPool::Serves(size, alignment)) return true;
+        return SizeClassPool::Default().Reserve(size, count, lock);
+    }
+    static size_t Capacity(size_t size, size_t alignment) {
+        return SizeClassPool::Serves(size, alignment) ? SizeClassPool::Default().Capacity(size) : 0;
+    }
+    static size_t Available(size_t size, size_t alignment) {
+        return SizeClassPool::Serves(size, alignment) ? SizeClassPool::Default().Available(size) : 0;
+    }
+};
+/// @brief  Standard allocator drawing from the shared SizeClassPool, with
+///         the same heap fallback as SizeClassStorage. Lets small shared
+///         state, e.g. std::allocate_shared control blocks, share the pool.
+/// @tparam T   The allocated type
+template<typename T>
+class SizeClassAllocator {
+public:
+    using value_type = T;
+
+    SizeClassAllocator() noexcept = default;
+    template<typename U>
+    SizeClassAllocator(SizeClassAllocator<U> const&) noexcept {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(SizeClassStorage::Allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* memory, size_t count) noexcept {
+        SizeClassStorage::Deallocate(memory, count * sizeof(T), alignof(T));
+    }
+    template<typename U>
+    bool operator==(SizeClassAllocator<U> const&) const noexcept { return true; }
+};
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <SpillSink.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace pentifica::log {
+namespace {
+    /// @brief  Write all of the data at the indicated offset
+    /// @return False if the data could not be written
+    bool WriteAt(int fd, void const* data, size_t size, std::uint64_t offset) {
+        auto next = static_cast<char const*>(data);
+        while(size > 0) {
+            auto const written = ::pwrite(fd, next, size, static_cast<off_t>(offset));
+            if(written < 0 && errno == EINTR) continue;
+            if(written <= 0) return false;
+            next += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<std::uint64_t>(written);
+        }
+        return true;
+    }
+}
+
+SpillSink::SpillSink(std::streambuf& sink,
+                     std::string path,
+                     std::chrono::microseconds threshold,
+                     std::chrono::milliseconds probe) :
+    sink_{sink},
+    path_{std::move(path)},
+    threshold_{threshold},
+    probe_{probe}
+{
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if(fd_ < 0) throw std::system_error(errno, std::generic_category(), path_);
+}
+
+SpillSink::~SpillSink() {
+    if(!record_.empty()) EndRecord();
+    Replay(true);
+    sink_.pubsync();
+    auto const kept = Spilling();
+    if(kept) Compact();
+    ::close(fd_);
+    if(!kept) ::unlink(path_.c_str());
+}
+
+SpillSink::int_type
+SpillSink::overflow(int_type c) {
+    if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    record_.push_back(traits_type::to_char_type(c));
+    if(traits_type::to_char_type(c) == '\n') EndRecord();
+    return c;
+}
+
+std::streamsize
+SpillSink::xsputn(char const* text, std::streamsize count) {
+    auto next = text;
+    auto const end = text + count;
+    while(next != end) {
+        auto const newline = static_cast<char const*>(std::memchr(next, '\n', static_cast<size_t>(end - next)));
+        if(newline == nullptr) {
+            record_.append(next, end);
+            break;
+        }
+        record_.append(next, newline + 1);
+        EndRecord();
+        next = newline + 1;
+    }
+    return count;
+}
+
+int
+SpillSink::sync() {
+    if(Spilling()) {
+        Replay();
+        return 0;
+    }
+    auto const start = Clock::now();
+    auto const result = sink_.pubsync();
+    if(Clock::now() - start > threshold_) Stalled();
+    return result;
+}
+
+void
+SpillSink::EndRecord() {
+    if(Spilling()) Replay();
+    if(Spilling() || Clock::now() < next_probe_) Spill(record_.data(), record_.size());
+    else Deliver(record_.data(), record_.size());
+    record_.clear();
+}
+
+bool
+SpillSink::Deliver(char const* text, size_t size) {
+    auto const start = Clock::now();
+    auto const written = static_cast<size_t>(std::max<std::streamsize>(
+        sink_.sputn(text, static_cast<std::streamsize>(size)), 0));
+    if(written < size) {
+        Stalled();
+        Spill(text + written, size - written);
+        return false;
+    }
+    if(Clock::now() - start > threshold_) {
+        Stalled();
+        return false;
+    }
+    return true;
+}
+
+void
+SpillSink::Spill(char const* text, size_t size) {
+    auto const length = static_cast<std::uint32_t>(size);
+    if(WriteAt(fd_, &length, sizeof(length), write_) &&
+       WriteAt(fd_, text, size, write_ + sizeof(length))) {
+        write_ += sizeof(length) + size;
+        ++spilled_;
+        return;
+    }
+
+    // Writing to the sink now would put the line ahead of spilled lines
+    if(!Spilling() &&
+       sink_.sputn(text, static_cast<std::streamsize>(size)) == static_cast<std::streamsize>(size)) return;
+    ++dropped_;
+}
+
+void
+SpillSink::Replay(bool force) {
+    if(!force && Clock::now() < next_probe_) return;
+
+    while(read_ != write_) {
+        std::uint32_t length{};
+        if(::pread(fd_, &length, sizeof(length), static_cast<off_t>(read_)) != sizeof(length)) break;
+        replay_.resize(length);
+        if(::pread(fd_, replay_.data(), length, static_cast<off_t>(read_ + sizeof(length))) != length) break;
+        read_ += sizeof(length) + length;
+        ++replayed_;
+
+        auto const start = Clock::now();
+        auto const written = static_cast<size_t>(std::max<std::streamsize>(
+            sink_.sputn(replay_.data(), static_cast<std::streamsize>(length)), 0));
+        if(written < length) {
+            // Put the unwritten remainder back as the oldest record
+            auto const remaining = static_cast<std::uint32_t>(length - written);
+            if(WriteAt(fd_, &remaining, sizeof(remaining), read_ - sizeof(remaining) - remaining)) {
+                read_ -= sizeof(remaining) + remaining;
+                --replayed_;
+            }
+            else ++dropped_;
+            Stalled();
+            return;
+        }
+        else if(!force && Clock::now() - start > threshold_) {
+            Stalled();
+            return;
+        }
+    }
+
+    // Offsets restart only once the file is empty; otherwise records are
+    // appended after the replayed ones
+    if(read_ == write_ && read_ != 0 && ::ftruncate(fd_, 0) == 0) read_ = write_ = 0;
+}
+
+void
+SpillSink::Stalled() {
+    ++stalls_;
+    next_probe_ = Clock::now() + probe_;
+}
+
+bool
+SpillSink::Compact() {
+    replay_.resize(64 * 1024);
+    std::uint64_t moved{};
+    while(read_ + moved < write_) {
+        auto const size = static_cast<size_t>(std::min<std::uint64_t>(replay_.size(), write_ - read_ - moved));
+        if(::pread(fd_, replay_.data(), size, static_cast<off_t>(read_ + moved)) != static_cast<ssize_t>(size)) return false;
+        if(!WriteAt(fd_, replay_.data(), size, moved)) return false;
+        moved += size;
+    }
+    return ::ftruncate(fd_, static_cast<off_t>(moved)) == 0;
+}
+}
\ No newline at end of file
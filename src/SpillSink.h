@@ -0,0 +1,121 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include    <chrono>
+#include    <cstdint>
+#include    <streambuf>
+#include    <string>
+
+namespace pentifica::log {
+/// @brief  Stream buffer that protects a flush from a stalling sink, e.g.
+///             SpillSink spill{*file.rdbuf(), "/var/tmp/app.spill", 5ms};
+///             std::ostream os{&spill};
+///             Manager manager{os, capacity};
+///         Each line is written to the sink and timed. When a write takes
+///         longer than the threshold, the sink is considered stalled and
+///         lines are appended to a local spill file as length prefixed
+///         records instead, so the flush keeps draining the Manager's queue.
+///         Once per probe interval the spilled records are replayed, oldest
+///         first; when they are all written within the threshold, lines go
+///         to the sink directly again. Lines are always written in order.
+class SpillSink :
+    public std::streambuf
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    /// @brief  Prepare a sink
+    /// @param  sink        Where lines are written; must outlive the SpillSink
+    /// @param  path        The spill file; created, or truncated, now and
+    ///                     removed when the SpillSink is destroyed, unless
+    ///                     the sink failed to take every spilled record
+    /// @param  threshold   A write taking longer than this marks a stall
+    /// @param  probe       The minimum time between replays of the spill file
+    /// @throws std::system_error if the spill file could not be created
+    SpillSink(std::streambuf& sink,
+              std::string path,
+              std::chrono::microseconds threshold,
+              std::chrono::milliseconds probe = std::chrono::milliseconds(100));
+    /// @brief Deleted
+    SpillSink(SpillSink const&) = delete;
+    /// @brief Deleted
+    SpillSink(SpillSink&&) = delete;
+    /// @brief  Replays the spill file, however slow the sink, and removes it.
+    ///         If the sink fails to take a record, the records not replayed
+    ///         are moved to the start of the file and the file is kept.
+    ~SpillSink() override;
+    /// @brief Deleted
+    SpillSink& operator=(SpillSink const&) = delete;
+    /// @brief Deleted
+    SpillSink& operator=(SpillSink&&) = delete;
+    /// @brief  Indicates if lines are being spilled
+    bool Spilling() const noexcept { return read_ != write_; }
+    /// @brief  The number of lines written to the spill file
+    size_t Spilled() const noexcept { return spilled_; }
+    /// @brief  The number of spilled lines replayed to the sink
+    size_t Replayed() const noexcept { return replayed_; }
+    /// @brief  The number of stalls detected
+    size_t Stalls() const noexcept { return stalls_; }
+    /// @brief  The number of lines lost because neither the spill file nor
+    ///         the sink would take them
+    size_t Dropped() const noexcept { return dropped_; }
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(char const* text, std::streamsize count) override;
+    /// @brief  Flush the sink, or replay the spill file if a probe is due
+    int sync() override;
+
+private:
+    /// @brief  Write the current line to the sink or the spill file
+    void EndRecord();
+    /// @brief  Write to the sink, timing the write
+    /// @return False if the write stalled
+    bool Deliver(char const* text, size_t size);
+    /// @brief  Append a record to the spill file. If the spill file cannot
+    ///         be written, the line is written to the sink, however slow, or
+    ///         dropped if older lines are still spilled.
+    void Spill(char const* text, size_t size);
+    /// @brief  Replay spilled records until the sink stalls
+    /// @param  force   Replay every record, however slow the sink
+    void Replay(bool force = false);
+    /// @brief  Note a stall; the next replay is after the probe interval
+    void Stalled();
+    /// @brief  Move the records not yet replayed to the start of the file
+    /// @return False if the spill file could not be rewritten
+    bool Compact();
+
+    std::streambuf& sink_;
+    std::string const path_;
+    Clock::duration const threshold_;
+    Clock::duration const probe_;
+    int fd_{-1};
+    /// @brief  Offset of the oldest spilled record not yet replayed
+    std::uint64_t read_{};
+    /// @brief  Offset at which the next record is spilled
+    std::uint64_t write_{};
+    Clock::time_point next_probe_{};
+    std::string record_;
+    std::string replay_;
+    size_t spilled_{};
+    size_t replayed_{};
+    size_t stalls_{};
+    size_t dropped_{};
+};
+}
\ No newline at end of file
@@ -0,0 +1,332 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+#include <Trace.h>
+#include <Factory.h>
+#include <Manager.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <typeinfo>
+#include <utility>
+
+namespace pentifica::log {
+namespace {
+    constexpr char trace_magic[8] = {'P', 'L', 'T', 'R', 'A', 'C', 'E', '1'};
+
+    enum Tag : char {
+        TypeTag = 'T',
+        EventTag = 'E',
+        SignedTag = 'i',
+        UnsignedTag = 'u',
+        DoubleTag = 'd',
+        BoolTag = 'b',
+        CharTag = 'c',
+        StringTag = 's',
+    };
+
+    template<typename T>
+    void Put(std::string& buffer, T value) {
+        buffer.append(reinterpret_cast<char const*>(&value), sizeof(value));
+    }
+
+    void PutString(std::string& buffer, std::string_view value) {
+        Put(buffer, static_cast<std::uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    template<typename T>
+    bool Get(std::istream& is, T& value) {
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool GetString(std::istream& is, std::string& value) {
+        std::uint32_t size{};
+        if(!Get(is, size)) return false;
+        value.resize(size);
+        return static_cast<bool>(is.read(value.data(), size));
+    }
+}
+
+/// @brief  Appends the fields of an event to the trace buffer
+class TraceRecorder::Encoder :
+    public FieldVisitor
+{
+public:
+    explicit Encoder(std::string& buffer) : buffer_{buffer} {}
+    void Field(std::int64_t value) override { Tagged(SignedTag, value); }
+    void Field(std::uint64_t value) override { Tagged(UnsignedTag, value); }
+    void Field(double value) override { Tagged(DoubleTag, value); }
+    void Field(bool value) override { Tagged(BoolTag, value); }
+    void Field(char value) override { Tagged(CharTag, value); }
+    void Field(std::string_view value) override {
+        ++count_;
+        Put(buffer_, StringTag);
+        PutString(buffer_, value);
+    }
+    std::uint16_t Count() const noexcept { return count_; }
+
+private:
+    template<typename T>
+    void Tagged(Tag tag, T value) {
+        ++count_;
+        Put(buffer_, tag);
+        Put(buffer_, value);
+    }
+
+    std::string& buffer_;
+    std::uint16_t count_{};
+};
+
+TraceRecorder::TraceRecorder(std::string const& path) {
+    file_.exceptions(std::ios::failbit | std::ios::badbit);
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    file_.write(trace_magic, sizeof(trace_magic));
+    // Later failures are counted rather than thrown on the enqueue path
+    file_.exceptions(std::ios::goodbit);
+}
+
+TraceRecorder::~TraceRecorder() {
+    Flush();
+}
+
+void
+TraceRecorder::Record(Event const& event) {
+    // The event is encoded, after its type, on the calling thread; only the
+    // type lookup and the append are serialized
+    thread_local std::string encoded;
+    encoded.clear();
+    Put(encoded, static_cast<std::uint8_t>(event.GetSeverity()));
+    Put(encoded, static_cast<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(event.GetTime().time_since_epoch()).count()));
+
+    // The field count precedes the fields; patch it once they are encoded
+    auto const count_offset = encoded.size();
+    Put(encoded, std::uint16_t{});
+    Encoder encoder{encoded};
+    event.Visit(encoder);
+    auto const count = encoder.Count();
+    std::memcpy(encoded.data() + count_offset, &count, sizeof(count));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto [type, added] = types_.try_emplace(std::type_index(typeid(event)), static_cast<std::uint32_t>(types_.size()));
+    if(added) {
+        Put(buffer_, TypeTag);
+        Put(buffer_, type->second);
+        PutString(buffer_, typeid(event).name());
+    }
+    Put(buffer_, EventTag);
+    Put(buffer_, type->second);
+    buffer_.append(encoded);
+
+    ++recorded_;
+    ++buffered_;
+    if(buffer_.size() >= 64 * 1024) Write(lock);
+}
+
+void
+TraceRecorder::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Write(lock);
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    file_.flush();
+}
+
+void
+TraceRecorder::Write(std::unique_lock<std::mutex>& lock) {
+    // Waits for the previous buffer, then takes over the file before the
+    // encoding lock is released
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    writing_.swap(buffer_);
+    auto const events = std::exchange(buffered_, 0);
+    lock.unlock();
+
+    if(!file_.write(writing_.data(), static_cast<std::streamsize>(writing_.size()))) lost_ += events;
+    writing_.clear();
+}
+
+size_t
+TraceRecorder::Recorded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recorded_;
+}
+
+size_t
+TraceRecorder::Lost() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return lost_;
+}
+
+TraceReader::TraceReader(std::string const& path) :
+    file_{path, std::ios::binary}
+{
+    char magic[sizeof(trace_magic)]{};
+    if(!file_.read(magic, sizeof(magic)) || std::memcmp(magic, trace_magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("not a trace file: " + path);
+    }
+}
+
+bool
+TraceReader::Next(TraceRecord& record) {
+    char tag{};
+    while(Get(file_, tag)) {
+        if(tag == TypeTag) {
+            std::uint32_t type{};
+            std::string name;
+            if(!Get(file_, type) || !GetString(file_, name)) break;
+            if(types_.size() <= type) types_.resize(type + 1);
+            types_[type] = std::move(name);
+            continue;
+        }
+        if(tag != EventTag) break;
+
+        std::uint8_t severity{};
+        std::int64_t nanoseconds{};
+        std::uint16_t count{};
+        if(!Get(file_, record.type_) || !Get(file_, severity) || !Get(file_, nanoseconds) || !Get(file_, count)) break;
+        record.severity_ = static_cast<Severity>(severity);
+        record.time_ = Event::TimePoint(std::chrono::duration_cast<Event::Clock::duration>(
+            std::chrono::nanoseconds(nanoseconds)));
+
+        record.fields_.clear();
+        for(std::uint16_t i = 0; i < count; ++i) {
+            char field{};
+            if(!Get(file_, field)) return false;
+            switch(field) {
+                case SignedTag:     { std::int64_t v{};  Get(file_, v); record.fields_.emplace_back(v); break; }
+                case UnsignedTag:   { std::uint64_t v{}; Get(file_, v); record.fields_.emplace_back(v); break; }
+                case DoubleTag:     { double v{};        Get(file_, v); record.fields_.emplace_back(v); break; }
+                case BoolTag:       { bool v{};          Get(file_, v); record.fields_.emplace_back(v); break; }
+                case CharTag:       { char v{};          Get(file_, v); record.fields_.emplace_back(v); break; }
+                case StringTag:     { std::string v;     GetString(file_, v); record.fields_.emplace_back(std::move(v)); break; }
+                default:            return false;
+            }
+        }
+        return static_cast<bool>(file_);
+    }
+    return false;
+}
+
+ReplayEvent::ReplayEvent(Severity severity, TimePoint time, std::span<TraceValue> fields) :
+    Event(severity, time),
+    count_{std::min(fields.size(), max_fields)}
+{
+    std::move(fields.begin(), fields.begin() + static_cast<std::ptrdiff_t>(count_), fields_.begin());
+}
+
+void
+ReplayEvent::Visit(FieldVisitor& visitor) const {
+    for(size_t i = 0; i < count_; ++i) {
+        std::visit([&visitor](auto const& value) { VisitField(visitor, value); }, fields_[i]);
+    }
+}
+
+void
+ReplayEvent::Log(std::ostream& os) const {
+    FieldWriter writer{os};
+    for(size_t i = 0; i < count_; ++i) {
+        std::visit([&writer](auto const& value) { writer.Write(value); }, fields_[i]);
+    }
+}
+
+namespace {
+    constexpr size_t replay_pools = 32;
+
+    using ReplayCreator = EventRef(*)(TraceRecord&);
+
+    template<size_t... Pools>
+    constexpr auto ReplayCreators(std::index_sequence<Pools...>) {
+        return std::array<ReplayCreator, sizeof...(Pools)>{
+            [](TraceRecord& record) {
+                return Factory<PooledReplayEvent<Pools>>::Create(record.severity_, record.time_, std::span<TraceValue>(record.fields_));
+            }...
+        };
+    }
+
+    /// @brief  Create the event of a record from the pool of its type
+    EventRef CreateReplayEvent(TraceRecord& record) {
+        static constexpr auto creators = ReplayCreators(std::make_index_sequence<replay_pools>{});
+        return creators[std::min<size_t>(record.type_, replay_pools - 1)](record);
+    }
+}
+
+ReplayReport
+Replay(TraceReader& reader, Manager& manager, ReplayOptions const& options) {
+    using Clock = std::chrono::steady_clock;
+
+    if(!manager.WritesEachEvent()) {
+        throw std::invalid_argument("replay needs a manager without routes, coalescing, aggregation or a flight recorder");
+    }
+
+    ReplayReport report;
+    std::vector<std::chrono::nanoseconds> latencies;
+    std::deque<Clock::time_point> enqueued;
+    auto const flush_every = std::max<size_t>(options.flush_every_, 1);
+
+    auto complete = [&](auto&& flush) {
+        auto const published = manager.Published();
+        auto const dropped = manager.Dropped();
+        flush();
+        auto const now = Clock::now();
+        for(auto count = manager.Dropped() - dropped; count-- && !enqueued.empty();) {
+            enqueued.pop_front();
+            ++report.dropped_;
+        }
+        for(auto count = manager.Published() - published; count-- && !enqueued.empty();) {
+            latencies.push_back(now - enqueued.front());
+            enqueued.pop_front();
+        }
+    };
+
+    TraceRecord record;
+    Event::TimePoint first_event{};
+    auto const start = Clock::now();
+    while(reader.Next(record)) {
+        if(report.events_ == 0) first_event = record.time_;
+        if(options.speed_ > 0) {
+            auto const offset = std::chrono::duration_cast<Clock::duration>(
+                (record.time_ - first_event) / options.speed_);
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        enqueued.push_back(Clock::now());
+        manager.Enqueue(CreateReplayEvent(record));
+        if(++report.events_ % flush_every == 0) complete([&] { manager.Flush(flush_every); });
+    }
+    complete([&] { manager.Dump(); });
+    report.elapsed_ = Clock::now() - start;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double fraction) {
+        if(latencies.empty()) return std::chrono::nanoseconds{};
+        auto const index = static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1));
+        return latencies[index];
+    };
+    report.p50_ = percentile(0.5);
+    report.p90_ = percentile(0.9);
+    report.p99_ = percentile(0.99);
+    report.p999_ = percentile(0.999);
+    report.max_ = percentile(1);
+    return report;
+}
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#pragma once
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+#include <Event.h>
+#include <Utility.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace pentifica::log {
+class Manager;
+/// @brief  A field value read from a trace
+using TraceValue = std::variant<std::int64_t, std::uint64_t, double, bool, char, std::string>;
+/// @brief  An event read from a trace
+struct TraceRecord {
+    /// @brief  Identifies the event type within the trace (see TypeName)
+    std::uint32_t type_{};
+    Severity severity_{Severity::Debug};
+    Event::TimePoint time_{};
+    std::vector<TraceValue> fields_{};
+};
+
+/// @brief  Saves a binary trace of the events enqueued on a Manager (see
+///         Manager::SetTrace): the type, severity and time of each event and
+///         its fields as tagged values (see Event::Visit). Thread safe.
+///         Events are encoded into a buffer; a full buffer is handed off and
+///         written outside the encoding lock. Write failures never throw;
+///         the events in a buffer that could not be written are counted as
+///         lost.
+class TraceRecorder {
+public:
+    /// @brief  Create the trace file
+    /// @param  path    The trace file; truncated if it exists
+    /// @throws std::ios_base::failure if the file could not be created
+    explicit TraceRecorder(std::string const& path);
+    /// @brief Deleted
+    TraceRecorder(TraceRecorder const&) = delete;
+    /// @brief  Write the buffered trace to the file
+    ~TraceRecorder();
+    /// @brief Deleted
+    TraceRecorder& operator=(TraceRecorder const&) = delete;
+    /// @brief  Append an event to the trace
+    /// @param  event   The event to append
+    void Record(Event const& event);
+    /// @brief  Write the buffered trace to the file
+    void Flush();
+    /// @brief  The number of events recorded
+    size_t Recorded() const;
+    /// @brief  The number of recorded events that could not be written
+    size_t Lost() const;
+
+private:
+    class Encoder;
+
+    /// @brief  Hand the buffer off to be written, releasing the encoding
+    ///         lock before writing so other threads keep recording
+    /// @param  lock    The lock held on mutex_
+    void Write(std::unique_lock<std::mutex>& lock);
+
+    /// @brief  Guards the encoding state
+    mutable std::mutex mutex_;
+    std::unordered_map<std::type_index, std::uint32_t> types_;
+    std::string buffer_;
+    size_t buffered_{};
+    size_t recorded_{};
+    /// @brief  Guards the file; taken while mutex_ is held, so buffers are
+    ///         written in the order they were filled
+    mutable std::mutex write_mutex_;
+    std::ofstream file_;
+    std::string writing_;
+    size_t lost_{};
+};
+
+/// @brief  Reads the events saved by a TraceRecorder, in order
+class TraceReader {
+public:
+    /// @brief  Open a trace file
+    /// @param  path    The trace file
+    /// @throws std::runtime_error if the file is not a trace
+    explicit TraceReader(std::string const& path);
+    /// @brief  Read the next event
+    /// @param  record  Receives the event
+    /// @return False at the end of the trace
+    bool Next(TraceRecord& record);
+    /// @brief  The name of an event type, as reported by typeid
+    /// @param  type    The type read with the event
+    std::string const& TypeName(std::uint32_t type) const { return types_.at(type); }
+
+private:
+    std::ifstream file_;
+    std::vector<std::string> types_;
+};
+
+/// @brief  An event replayed from a trace. Streams its fields as the
+///         GenericEvent it was recorded from would. The fields are held
+///         inline, so a pooled instance does not allocate for them; only
+///         string fields longer than the small string buffer do. Replay
+///         still differs from production in that every type is formatted
+///         by this class rather than by its own Log, and fields beyond
+///         max_fields are dropped.
+class ReplayEvent :
+    public Event
+{
+public:
+    static constexpr size_t max_fields = 16;
+    /// @brief  Prepare an event from the fields of a record
+    /// @param  severity    The recorded severity
+    /// @param  time        The recorded time
+    /// @param  fields      The recorded fields; moved from
+    ReplayEvent(Severity severity, TimePoint time, std::span<TraceValue> fields);
+    void Visit(FieldVisitor& visitor) const override;
+
+protected:
+    void Log(std::ostream& os) const override;
+
+private:
+    std::array<TraceValue, max_fields> fields_;
+    size_t count_{};
+};
+
+/// @brief  A ReplayEvent drawn from its own Factory pool, so each recorded
+///         type is replayed through a pool of its own, as in production.
+///         Types beyond the last pool share it.
+/// @tparam Pool    The index of the pool
+template<size_t Pool>
+class PooledReplayEvent :
+    public ReplayEvent
+{
+public:
+    using ReplayEvent::ReplayEvent;
+};
+
+/// @brief  Controls how a trace is replayed
+struct ReplayOptions {
+    /// @brief  Multiple of the original rate to replay at (0 = as fast as
+    ///         possible)
+    double speed_{0};
+    /// @brief  Flush the Manager after this many events
+    size_t flush_every_{1024};
+};
+
+/// @brief  The outcome of a replay
+struct ReplayReport {
+    size_t events_{};
+    size_t dropped_{};
+    std::chrono::nanoseconds elapsed_{};
+    /// @brief  Enqueue to write latency percentiles
+    std::chrono::nanoseconds p50_{}, p90_{}, p99_{}, p999_{}, max_{};
+    /// @brief  Events replayed per second
+    double Throughput() const {
+        auto const seconds = std::chrono::duration<double>(elapsed_).count();
+        return seconds > 0 ? static_cast<double>(events_) / seconds : 0;
+    }
+};
+
+/// @brief  Drive a Manager with the events of a trace, as ReplayEvent
+///         instances created from a Factory pool per recorded type,
+///         measuring the time from each enqueue to the flush that wrote the
+///         event. Latency is attributed by matching published events to
+///         enqueued events in order, so the Manager must write each event
+///         once (see Manager::WritesEachEvent).
+/// @param  reader  The trace to replay
+/// @param  manager Where to enqueue the events
+/// @param  options How to replay the trace
+/// @return The throughput and latency of the replay
+/// @throws std::invalid_argument if the Manager has routes, coalescing,
+///         aggregation or a flight recorder configured
+ReplayReport Replay(TraceReader& reader, Manager& manager, ReplayOptions const& options = {});
+}
\ No newline at end of file
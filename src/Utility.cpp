@@ -18,15 +18,19 @@
 /// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 /// SOFTWARE.
 #include    "Event.h"
+#include    "Utility.h"
 
 #include    <iostream>
 #include    <iomanip>
+#include    <sstream>
 #include    <ctime>
+#include    <typeinfo>
 
-std::ostream& operator<<(std::ostream& os, pentifica::log::Event const& event) {
-    using Clock = pentifica::log::Event::Clock;
+namespace pentifica::log {
+std::ostream& StreamTime(std::ostream& os, Event::TimePoint time) {
+    using Clock = Event::Clock;
 
-    auto clock_time = Clock::to_time_t(event.time_);
+    auto clock_time = Clock::to_time_t(time);
     std::tm tm{0};
     localtime_r(&clock_time, &tm);
 
@@ -51,11 +55,53 @@ std::ostream& operator<<(std::ostream& os, pentifica::log::Event const& event) {
     mask[17] += tm.tm_sec / 10;
     mask[18] += tm.tm_sec % 10;
 
-    auto frac = event.time_ - Clock::from_time_t(clock_time);
+    auto frac = time - Clock::from_time_t(clock_time);
     auto microseconds = frac / std::chrono::microseconds(1);
 
-    os << mask
-       << std::setw(6) << std::setfill('0') << microseconds
+    return os << mask
+              << std::setw(6) << std::setfill('0') << microseconds;
+}
+
+void
+AsJson::Write(std::ostream& os) const {
+    os << "{\"time\":\"";
+    StreamTime(os, event_.time_) << "\",\"severity\":\"";
+
+    std::string_view severity{ToString(event_.severity_)};
+    severity = severity.substr(0, severity.find(' '));
+    os.write(severity.data(), static_cast<std::streamsize>(severity.size()));
+    os << '"';
+
+    event_.LogJson(os);
+    os << "}\n";
+}
+
+void
+Event::Snapshot(SnapshotWriter& writer) const noexcept {
+    writer.Write(typeid(*this).name());
+}
+
+void
+Event::Visit(FieldVisitor& visitor) const {
+    std::ostringstream oss;
+    Log(oss);
+    visitor.Field(std::string_view(oss.str()));
+}
+
+void
+Event::LogJson(std::ostream& os) const {
+    os << ",\"message\":\"";
+    {
+        JsonEscapeBuf escape{os.rdbuf()};
+        std::ostream escaped{&escape};
+        Log(escaped);
+    }
+    os << '"';
+}
+}
+
+std::ostream& operator<<(std::ostream& os, pentifica::log::Event const& event) {
+    pentifica::log::StreamTime(os, event.time_)
        << " [" << pentifica::log::ToString(event.severity_) << "] ";
 
     event.Log(os);
@@ -20,8 +20,381 @@
 /// SOFTWARE.
 #include <tuple>
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 
 namespace pentifica::log {
+/// @brief  The heap memory owned by a field, beyond the size of the field
+///         itself. Types may report their own footprint through a
+///         Footprint() member.
+/// @tparam T       The field type
+/// @param  value   The field
+/// @return The number of bytes owned by the field
+template<typename T>
+size_t FieldFootprint(T const& value) noexcept {
+    if constexpr(requires { { value.Footprint() } -> std::convertible_to<size_t>; }) {
+        return value.Footprint();
+    }
+    else if constexpr(std::is_same_v<T, std::string>) {
+        auto const data = reinterpret_cast<std::byte const*>(value.data());
+        auto const self = reinterpret_cast<std::byte const*>(&value);
+        auto const inline_storage = data >= self && data < self + sizeof(value);
+        return inline_storage ? 0 : value.capacity() + 1;
+    }
+    else {
+        return 0;
+    }
+}
+/// @brief  Stream buffer that escapes the characters written to it for use
+///         inside a JSON string, forwarding the result to another stream
+///         buffer. Used to escape the output of operator<< without building
+///         an intermediate string.
+class JsonEscapeBuf :
+    public std::streambuf
+{
+public:
+    /// @brief  Prepare to escape characters written to the indicated buffer
+    /// @param  target  Where to write the escaped characters
+    explicit JsonEscapeBuf(std::streambuf* target) : target_{target} {}
+    /// @brief  Write the characters escaped to the indicated buffer
+    /// @param  target  Where to write the escaped characters
+    /// @param  text    The characters to escape
+    static void Escape(std::streambuf* target, std::string_view text) {
+        size_t run{};
+        for(size_t i = 0; i < text.size(); ++i) {
+            auto const c = static_cast<unsigned char>(text[i]);
+            if(c >= 0x20 && c != '"' && c != '\\') continue;
+            target->sputn(text.data() + run, static_cast<std::streamsize>(i - run));
+            run = i + 1;
+            switch(c) {
+                case '"':   target->sputn("\\\"", 2); break;
+                case '\\':  target->sputn("\\\\", 2); break;
+                case '\n':  target->sputn("\\n", 2); break;
+                case '\r':  target->sputn("\\r", 2); break;
+                case '\t':  target->sputn("\\t", 2); break;
+                default: {
+                    constexpr char digits[] = "0123456789abcdef";
+                    char const code[] = {'\\', 'u', '0', '0', digits[c >> 4], digits[c & 0x0f]};
+                    target->sputn(code, sizeof(code));
+                }
+            }
+        }
+        target->sputn(text.data() + run, static_cast<std::streamsize>(text.size() - run));
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        char const ch = traits_type::to_char_type(c);
+        Escape(target_, std::string_view(&ch, 1));
+        return c;
+    }
+    std::streamsize xsputn(char const* text, std::streamsize count) override {
+        Escape(target_, std::string_view(text, static_cast<size_t>(count)));
+        return count;
+    }
+
+private:
+    std::streambuf* target_;
+};
+/// @brief  Renders values into a fixed buffer using only async-signal-safe
+///         operations, for use when the process is crashing. Values that
+///         cannot be rendered safely are rendered as '?'. Output beyond the
+///         end of the buffer is discarded; a number that does not fit ends
+///         the rendering, so no partial digits are written.
+class SnapshotWriter {
+public:
+    /// @brief  Prepare to render into the indicated buffer
+    /// @param  buffer  Where to render
+    /// @param  size    The size of the buffer
+    SnapshotWriter(char* buffer, size_t size) noexcept :
+        first_{buffer}, next_{buffer}, last_{buffer + size} {}
+    /// @brief  Render a value
+    /// @tparam T       The value type
+    /// @param  value   The value to render
+    /// @return This writer
+    template<typename T>
+    SnapshotWriter& Write(T const& value) noexcept {
+        using Type = std::remove_cvref_t<T>;
+        if constexpr(std::is_same_v<Type, bool>) {
+            Append(value ? "1" : "0");
+        }
+        else if constexpr(std::is_same_v<Type, char> ||
+                          std::is_same_v<Type, signed char> ||
+                          std::is_same_v<Type, unsigned char>) {
+            if(next_ != last_) *next_++ = static_cast<char>(value);
+        }
+        else if constexpr(std::is_integral_v<Type> ||
+                          std::is_same_v<Type, float> ||
+                          std::is_same_v<Type, double>) {
+            auto const [end, error] = std::to_chars(next_, last_, value);
+            if(error == std::errc{}) next_ = end;
+            else last_ = next_;
+        }
+        else if constexpr(std::is_same_v<Type, char const*> || std::is_same_v<Type, char*>) {
+            Append(value ? std::string_view(value) : std::string_view("(null)"));
+        }
+        else if constexpr(std::is_convertible_v<Type const&, std::string_view>) {
+            Append(std::string_view(value));
+        }
+        else {
+            Append("?");
+        }
+        return *this;
+    }
+    /// @brief  The rendered characters
+    std::string_view View() const noexcept { return {first_, static_cast<size_t>(next_ - first_)}; }
+
+private:
+    void Append(std::string_view text) noexcept {
+        auto const count = std::min(text.size(), static_cast<size_t>(last_ - next_));
+        std::memcpy(next_, text.data(), count);
+        next_ += count;
+    }
+
+    char* const first_;
+    char* next_;
+    char* last_;
+};
+/// @brief  Renders field values into a local buffer that is written to the
+///         stream in as few calls as possible. Arithmetic, boolean, character
+///         and string values are rendered with std::to_chars and table
+///         lookups, bypassing the locale facets of the stream. Any other type
+///         is streamed with operator<<. The output is identical to streaming
+///         each value, so the fast path is only taken while the stream has
+///         its default formatting state.
+class FieldWriter {
+    static constexpr size_t buffer_size = 256;
+
+public:
+    /// @brief  Prepare to render fields to the indicated stream
+    /// @param  os  Where to stream the rendered fields
+    explicit FieldWriter(std::ostream& os) :
+        os_{os},
+        fast_{os.flags() == (std::ios_base::skipws | std::ios_base::dec) &&
+              os.precision() == 6 && os.width() == 0} {}
+    /// @brief Deleted
+    FieldWriter(FieldWriter const&) = delete;
+    /// @brief Deleted
+    FieldWriter(FieldWriter&&) = delete;
+    /// @brief  Writes any buffered output to the stream
+    ~FieldWriter() { Flush(); }
+    /// @brief Deleted
+    FieldWriter& operator=(FieldWriter const&) = delete;
+    /// @brief Deleted
+    FieldWriter& operator=(FieldWriter&&) = delete;
+    /// @brief  Render a value
+    /// @tparam T       The value type
+    /// @param  value   The value to render
+    /// @return This writer
+    template<typename T>
+    FieldWriter& Write(T const& value) {
+        using Type = std::remove_cvref_t<T>;
+        if constexpr(std::is_same_v<Type, bool>) {
+            if(!fast_) return Stream(value);
+            *Reserve(1) = value ? '1' : '0';
+            ++used_;
+        }
+        else if constexpr(std::is_same_v<Type, char> ||
+                          std::is_same_v<Type, signed char> ||
+                          std::is_same_v<Type, unsigned char>) {
+            if(!fast_) return Stream(value);
+            *Reserve(1) = static_cast<char>(value);
+            ++used_;
+        }
+        else if constexpr(std::is_integral_v<Type> || std::is_floating_point_v<Type>) {
+            if(!fast_) return Stream(value);
+            if constexpr(std::is_floating_point_v<Type>) {
+                Render(value, std::chars_format::general, 6);
+            }
+            else {
+                Render(value);
+            }
+        }
+        else if constexpr(std::is_convertible_v<Type const&, std::string_view>) {
+            if(!fast_) return Stream(value);
+            Append(std::string_view(value));
+        }
+        else {
+            Stream(value);
+        }
+        return *this;
+    }
+    /// @brief  Render a value as a JSON value. Numbers and booleans are
+    ///         rendered bare (non-finite numbers as null); all other values
+    ///         are rendered as escaped strings.
+    /// @tparam T       The value type
+    /// @param  value   The value to render
+    /// @return This writer
+    template<typename T>
+    FieldWriter& WriteJson(T const& value) {
+        using Type = std::remove_cvref_t<T>;
+        if constexpr(std::is_same_v<Type, bool>) {
+            Append(value ? "true" : "false");
+        }
+        else if constexpr(std::is_same_v<Type, char> ||
+                          std::is_same_v<Type, signed char> ||
+                          std::is_same_v<Type, unsigned char>) {
+            auto const c = static_cast<char>(value);
+            WriteJson(std::string_view(&c, 1));
+        }
+        else if constexpr(std::is_integral_v<Type> || std::is_floating_point_v<Type>) {
+            if constexpr(std::is_floating_point_v<Type>) {
+                if(!std::isfinite(value)) Append("null");
+                else Render(value, std::chars_format::general);
+            }
+            else {
+                Render(value);
+            }
+        }
+        else if constexpr(std::is_convertible_v<Type const&, std::string_view>) {
+            Flush();
+            os_.rdbuf()->sputc('"');
+            JsonEscapeBuf::Escape(os_.rdbuf(), std::string_view(value));
+            os_.rdbuf()->sputc('"');
+        }
+        else {
+            Flush();
+            os_.rdbuf()->sputc('"');
+            JsonEscapeBuf escape{os_.rdbuf()};
+            std::ostream escaped{&escape};
+            escaped << value;
+            os_.rdbuf()->sputc('"');
+        }
+        return *this;
+    }
+    /// @brief  Render a value as a fixed number of lower case hexadecimal
+    ///         digits, two digits per table lookup.
+    /// @param  value   The value to render
+    /// @param  digits  The number of hexadecimal digits to render (max 16)
+    /// @return This writer
+    FieldWriter& WriteHex(std::uint64_t value, size_t digits = 2 * sizeof(std::uint64_t)) {
+        if(digits > 2 * sizeof(std::uint64_t)) digits = 2 * sizeof(std::uint64_t);
+        auto last = Reserve(digits) + digits;
+        auto remaining = digits;
+        for(; remaining >= 2; remaining -= 2, value >>= 8) {
+            last -= 2;
+            std::memcpy(last, HexPairs()[value & 0xff].data(), 2);
+        }
+        if(remaining) *--last = HexPairs()[value & 0x0f][1];
+        used_ += digits;
+        return *this;
+    }
+    /// @brief  Write any buffered output to the stream
+    void Flush() {
+        if(used_ == 0) return;
+        os_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+
+private:
+    using HexTable = std::array<std::array<char, 2>, 256>;
+    /// @brief  Lookup table mapping a byte to its two hexadecimal digits
+    static HexTable const& HexPairs() {
+        static constexpr HexTable table = [] {
+            constexpr char digits[] = "0123456789abcdef";
+            HexTable t{};
+            for(size_t i = 0; i < t.size(); ++i) t[i] = {digits[i >> 4], digits[i & 0x0f]};
+            return t;
+        }();
+        return table;
+    }
+    /// @brief  Ensure the buffer has room for the indicated number of chars
+    /// @param  size    The number of chars required (at most buffer_size)
+    /// @return Where to render the chars
+    char* Reserve(size_t size) {
+        if(buffer_size - used_ < size) Flush();
+        return buffer_.data() + used_;
+    }
+    /// @brief  Render a number with std::to_chars
+    /// @param  ...format   Optional format and precision for floating point
+    template<typename T, typename... Format>
+    void Render(T value, Format... format) {
+        constexpr size_t max_digits = 64;
+        auto first = Reserve(max_digits);
+        auto result = std::to_chars(first, first + max_digits, value, format...);
+        used_ += result.ptr - first;
+    }
+    /// @brief  Append the characters to the buffer, bypassing it when the
+    ///         characters would not fit.
+    void Append(std::string_view text) {
+        if(text.size() > buffer_size) {
+            Flush();
+            os_.write(text.data(), static_cast<std::streamsize>(text.size()));
+            return;
+        }
+        std::memcpy(Reserve(text.size()), text.data(), text.size());
+        used_ += text.size();
+    }
+    /// @brief  Stream the value using its operator<<
+    template<typename T>
+    FieldWriter& Stream(T const& value) {
+        Flush();
+        os_ << value;
+        return *this;
+    }
+
+    std::ostream& os_;
+    bool const fast_;
+    size_t used_{};
+    std::array<char, buffer_size> buffer_;
+};
+/// @brief  Receives the fields of an Event as one of a small set of value
+///         types (see Event::Visit), e.g. to record or store them.
+class FieldVisitor {
+public:
+    virtual ~FieldVisitor() = default;
+    virtual void Field(std::int64_t value) = 0;
+    virtual void Field(std::uint64_t value) = 0;
+    virtual void Field(double value) = 0;
+    virtual void Field(bool value) = 0;
+    virtual void Field(char value) = 0;
+    /// @brief  Strings, and fields of any other type rendered as text
+    virtual void Field(std::string_view value) = 0;
+};
+/// @brief  Pass a field to a visitor as the nearest visited type. Fields that
+///         are not arithmetic or strings are rendered with operator<<.
+/// @param  visitor Where to pass the field
+/// @param  value   The field
+template<typename T>
+void VisitField(FieldVisitor& visitor, T const& value) {
+    if constexpr(std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+        visitor.Field(value);
+    }
+    else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>) {
+        visitor.Field(static_cast<std::int64_t>(value));
+    }
+    else if constexpr(std::is_integral_v<T>) {
+        visitor.Field(static_cast<std::uint64_t>(value));
+    }
+    else if constexpr(std::is_floating_point_v<T>) {
+        visitor.Field(static_cast<double>(value));
+    }
+    else if constexpr(std::is_convertible_v<T const&, char const*>) {
+        char const* text = value;
+        visitor.Field(std::string_view(text ? text : ""));
+    }
+    else if constexpr(std::is_convertible_v<T const&, std::string_view>) {
+        visitor.Field(std::string_view(value));
+    }
+    else {
+        std::ostringstream oss;
+        oss << value;
+        visitor.Field(std::string_view(oss.str()));
+    }
+}
 /// @brief  Streams the tuple members
 /// @tparam TupleType   Type information
 /// @tparam ...Is   Indexes into the tuple
@@ -31,8 +404,8 @@ namespace pentifica::log {
 /// @return     The supplied stream
 template<typename TupleType, std::size_t... Is>
 std::ostream& PrintTuple(std::ostream& os, TupleType const& tp, std::index_sequence<Is...>) {
-    auto print_field = [&os](const auto& x) { os << x; };
-    (print_field(std::get<Is>(tp)), ...);
+    FieldWriter writer{os};
+    (writer.Write(std::get<Is>(tp)), ...);
     return os;
 }
 /// @brief  Streams a tuple
@@ -0,0 +1,51 @@
+/// @brief  Stand-in for a local log collector, used by Test_DatagramSink.
+///         Binds a Unix domain datagram socket, receives the indicated
+///         number of records and writes each to stdout as a line.
+///             log_collector <socket path> <record count>
+///         Exits with 1 if no record arrives for 5 seconds.
+#include    <cstdio>
+#include    <cstdlib>
+#include    <cstring>
+
+#include    <sys/socket.h>
+#include    <sys/un.h>
+#include    <unistd.h>
+
+int main(int argc, char* argv[]) {
+    if(argc != 3) {
+        std::fprintf(stderr, "usage: %s <socket path> <record count>\n", argv[0]);
+        return 2;
+    }
+    auto const path = argv[1];
+    auto const count = std::strtoul(argv[2], nullptr, 10);
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(std::strlen(path) >= sizeof(address.sun_path)) return 2;
+    std::strcpy(address.sun_path, path);
+
+    auto const fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if(fd < 0) return 2;
+    ::unlink(path);
+    if(::bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) return 2;
+
+    timeval timeout{5, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int status{};
+    static char record[64 * 1024];
+    for(unsigned long received = 0; received < count; ++received) {
+        auto const size = ::recv(fd, record, sizeof(record), 0);
+        if(size < 0) {
+            status = 1;
+            break;
+        }
+        std::fwrite(record, 1, static_cast<size_t>(size), stdout);
+        std::fputc('\n', stdout);
+    }
+
+    std::fflush(stdout);
+    ::close(fd);
+    ::unlink(path);
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include    <Category.h>
+
+#include    <gtest/gtest.h>
+
+#include    <sstream>
+
+namespace {
+    using namespace pentifica::log;
+
+    struct OrderBook : Category<1> {};
+    struct Gateway : Category<2> {};
+
+    using Registry = CategoryRegistry<Uncategorized, OrderBook, Gateway>;
+
+    using BookEvent = CategorizedEvent<OrderBook, char const*, int>;
+    using GatewayEvent = CategorizedEvent<Gateway, char const*, int>;
+    using PlainEvent = GenericEvent<char const*, int>;
+}
+
+TEST(Test_Category, registry) {
+    EXPECT_EQ(Registry::all, 0b111);
+    EXPECT_TRUE((std::is_same_v<CategoryOf<BookEvent>::type, OrderBook>));
+    EXPECT_TRUE((std::is_same_v<CategoryOf<PlainEvent>::type, Uncategorized>));
+}
+
+TEST(Test_Category, threshold) {
+    EXPECT_TRUE(Categories::Enabled<BookEvent>(Severity::Debug));
+
+    Categories::SetThreshold(Registry::all, Severity::Critical);
+    Categories::SetThreshold(OrderBook::mask, Severity::Debug);
+
+    EXPECT_TRUE(Categories::Enabled<BookEvent>(Severity::Debug));
+    EXPECT_FALSE(Categories::Enabled<GatewayEvent>(Severity::Info));
+    EXPECT_TRUE(Categories::Enabled<GatewayEvent>(Severity::Critical));
+    EXPECT_FALSE(Categories::Enabled<PlainEvent>(Severity::Logic));
+
+    Categories::Disable(OrderBook::mask);
+    EXPECT_FALSE(Categories::Enabled<BookEvent>(Severity::Fatal));
+
+    Categories::SetThreshold(Registry::all, Severity::Debug);
+    EXPECT_TRUE(Categories::Enabled<PlainEvent>(Severity::Debug));
+}
+
+TEST(Test_Category, emit) {
+    std::ostringstream oss;
+    Manager manager(oss, 10);
+
+    Categories::SetThreshold(Gateway::mask, Severity::Info);
+    EXPECT_TRUE(Emit<BookEvent>(manager, Severity::Debug, "book level ", 1));
+    EXPECT_FALSE(Emit<GatewayEvent>(manager, Severity::Debug, "gateway heartbeat ", 2));
+    EXPECT_TRUE(Emit<GatewayEvent>(manager, Severity::Info, "gateway login ", 3));
+    Categories::SetThreshold(Gateway::mask, Severity::Debug);
+
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 2);
+    EXPECT_NE(oss.str().find("book level 1"), std::string::npos);
+    EXPECT_EQ(oss.str().find("gateway heartbeat"), std::string::npos);
+    EXPECT_NE(oss.str().find("gateway login 3"), std::string::npos);
+}
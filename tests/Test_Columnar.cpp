@@ -0,0 +1,165 @@
+#include    <Columnar.h>
+#include    <Manager.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <cstdlib>
+#include    <filesystem>
+#include    <sstream>
+#include    <string>
+#include    <thread>
+
+#include    <unistd.h>
+
+namespace {
+    using namespace pentifica::log;
+
+    using TradeEvent = GenericEvent<char const*, std::int64_t, double, char, bool, unsigned>;
+    using NoteEvent = GenericEvent<std::string>;
+
+    char const* const symbols[] = {"AAPL", "MSFT", "IBM"};
+
+    std::filesystem::path TempDirectory() {
+        auto path = std::filesystem::temp_directory_path() / ("test_columnar_" + std::to_string(::getpid()));
+        std::filesystem::create_directories(path);
+        return path;
+    }
+}
+
+TEST(Test_Columnar, manager) {
+    auto const directory = TempDirectory();
+    constexpr size_t count{1000};
+    constexpr size_t block_rows{256};
+
+    std::ostringstream oss;
+    std::string trade_path;
+    std::string note_path;
+    {
+        ColumnarSink sink{directory.string(), block_rows};
+        trade_path = sink.Path(typeid(TradeEvent));
+        note_path = sink.Path(typeid(NoteEvent));
+
+        Manager manager(oss, count + 1);
+        manager.SetColumnar(&sink);
+        for(size_t i = 0; i < count; ++i) {
+            manager.Enqueue(Factory<TradeEvent>::Create(symbols[i % 3], std::int64_t(1000 + i), i * 0.25,
+                                                        i % 2 ? 'S' : 'B', i % 5 == 0, unsigned(i / 10)));
+        }
+        manager.Enqueue(Factory<NoteEvent>::Create(std::string("note")));
+        manager.Dump();
+
+        EXPECT_EQ(sink.Appended(), count + 1);
+        EXPECT_EQ(sink.Rejected(), 0);
+        EXPECT_EQ(manager.Published(), count + 1);
+        EXPECT_TRUE(oss.str().empty());
+    }
+
+    // Delta and dictionary encoding keep the file well below the text size
+    EXPECT_LT(std::filesystem::file_size(trade_path), count * 24);
+
+    ColumnarReader reader{trade_path};
+    EXPECT_EQ(reader.TypeName(), typeid(TradeEvent).name());
+    ASSERT_EQ(reader.ColumnCount(), 8);
+    EXPECT_EQ(reader.ColumnName(0), "time");
+    EXPECT_EQ(reader.Kind(2), ColumnKind::String);
+    EXPECT_EQ(reader.Kind(3), ColumnKind::Signed);
+    EXPECT_EQ(reader.Kind(4), ColumnKind::Double);
+    EXPECT_EQ(reader.Kind(7), ColumnKind::Unsigned);
+
+    auto const symbol = reader.Find("field0");
+    auto const price = reader.Find("field2");
+    size_t rows{};
+    size_t blocks{};
+    size_t skipped{};
+    while(reader.NextBlock()) {
+        ++blocks;
+        auto const& stats = reader.Stats(price);
+        EXPECT_EQ(stats.distinct_, 0);
+        // Skip blocks without prices above 200 using the statistics only
+        if(stats.Max<double>() <= 200) {
+            ++skipped;
+            rows += reader.Rows();
+            continue;
+        }
+
+        auto const prices = reader.Read(price);
+        auto const symbols_column = reader.Read(symbol);
+        EXPECT_EQ(reader.Stats(symbol).distinct_, 3);
+        ASSERT_EQ(prices.double_.size(), reader.Rows());
+        ASSERT_EQ(symbols_column.index_.size(), reader.Rows());
+        EXPECT_DOUBLE_EQ(prices.double_.front(), stats.Min<double>());
+        for(size_t row = 0; row < reader.Rows(); ++row) {
+            auto const i = rows + row;
+            EXPECT_DOUBLE_EQ(prices.double_[row], i * 0.25);
+            EXPECT_EQ(symbols_column.dictionary_[symbols_column.index_[row]], symbols[i % 3]);
+        }
+
+        auto const ids = reader.Read(reader.Find("field1"));
+        EXPECT_EQ(ids.signed_.front(), std::int64_t(1000 + rows));
+        auto const sides = reader.Read(reader.Find("field3"));
+        EXPECT_EQ(sides.byte_[0], rows % 2 ? 'S' : 'B');
+        auto const times = reader.Read(0);
+        EXPECT_TRUE(std::is_sorted(times.signed_.begin(), times.signed_.end()));
+        rows += reader.Rows();
+    }
+    EXPECT_EQ(rows, count);
+    EXPECT_EQ(blocks, (count + block_rows - 1) / block_rows);
+    EXPECT_EQ(skipped, 4 - 1);
+
+    ColumnarReader notes{note_path};
+    ASSERT_TRUE(notes.NextBlock());
+    EXPECT_EQ(notes.Rows(), 1);
+    auto const text = notes.Read(2);
+    EXPECT_EQ(text.dictionary_.at(text.index_.at(0)), "note");
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Test_Columnar, flush) {
+    using namespace std::chrono_literals;
+
+    auto const directory = TempDirectory();
+    {
+        ColumnarSink sink{directory.string(), 256, 20ms};
+        std::ostringstream oss;
+        Manager manager(oss, 10);
+        manager.SetColumnar(&sink);
+        auto enqueue = [&manager] {
+            for(int i = 0; i < 3; ++i) manager.Enqueue(Factory<NoteEvent>::Create(std::string("note")));
+        };
+
+        // A young partial block is kept by a flush
+        enqueue();
+        manager.Flush(10);
+        enqueue();
+        manager.Flush(10);
+        ColumnarReader notes{sink.Path(typeid(NoteEvent))};
+        EXPECT_FALSE(notes.NextBlock());
+
+        // and written by the first flush after it reaches the maximum age
+        std::this_thread::sleep_for(25ms);
+        enqueue();
+        manager.Flush(10);
+        ColumnarReader aged{sink.Path(typeid(NoteEvent))};
+        ASSERT_TRUE(aged.NextBlock());
+        EXPECT_EQ(aged.Rows(), 9);
+        EXPECT_FALSE(aged.NextBlock());
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Test_Columnar, unwritable_directory) {
+    std::ostringstream oss;
+    ColumnarSink sink{"/nonexistent/test_columnar"};
+    Manager manager(oss, 10);
+    manager.SetColumnar(&sink);
+    for(int i = 0; i < 3; ++i) manager.Enqueue(Factory<NoteEvent>::Create(std::string("note")));
+
+    // The failure is counted; the queue is still drained
+    manager.Dump();
+    EXPECT_EQ(sink.Failed(), 3);
+    EXPECT_EQ(sink.Appended(), 0);
+    EXPECT_EQ(manager.Published(), 3);
+    sink.Flush();
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include    <CrashHandler.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <csignal>
+#include    <cstdio>
+#include    <cstdlib>
+#include    <memory>
+#include    <sstream>
+#include    <string>
+#include    <vector>
+
+#include    <sys/wait.h>
+#include    <unistd.h>
+
+namespace {
+    using namespace pentifica::log;
+
+    using OrderEvent = GenericEvent<char const*, int, char const*, double>;
+}
+
+TEST(Test_CrashHandler, dump_on_fatal_signal) {
+    char path[] = "/tmp/test_crash_handlerXXXXXX";
+    auto const fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+
+    auto const child = fork();
+    ASSERT_GE(child, 0);
+    if(child == 0) {
+        std::ostringstream oss;
+        Manager manager(oss, 10);
+        CrashHandler::Install(fd);
+        CrashHandler::Register(manager);
+        manager.Enqueue(Factory<OrderEvent>::Create("order ", 1, " price ", 10.5));
+        manager.Enqueue(Factory<OrderEvent>::Create("order ", 2, " price ", 11.25));
+        manager.Flush(1);
+        std::raise(SIGSEGV);
+        std::_Exit(0);
+    }
+
+    int status{};
+    waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(WTERMSIG(status), SIGSEGV);
+
+    std::string text(4096, '\0');
+    auto const size = pread(fd, text.data(), text.size(), 0);
+    ASSERT_GT(size, 0);
+    text.resize(static_cast<size_t>(size));
+    close(fd);
+    unlink(path);
+
+    EXPECT_NE(text.find("*** fatal signal 11, pending events:"), std::string::npos);
+    EXPECT_EQ(text.find("order 1 price 10.5"), std::string::npos);
+    EXPECT_NE(text.find("[Debug   ] order 2 price 11.25\n"), std::string::npos);
+}
+
+TEST(Test_CrashHandler, register_limit) {
+    std::ostringstream oss;
+    std::vector<std::unique_ptr<Manager>> registry;
+    for(size_t i = 0; i < CrashHandler::max_managers + 1; ++i) registry.push_back(std::make_unique<Manager>(oss, 1));
+
+    size_t registered{};
+    for(auto& manager : registry) registered += CrashHandler::Register(*manager);
+    EXPECT_EQ(registered, CrashHandler::max_managers);
+
+    // Registering again does not take another slot
+    EXPECT_TRUE(CrashHandler::Register(*registry.front()));
+    CrashHandler::Unregister(*registry.front());
+    EXPECT_TRUE(CrashHandler::Register(*registry.back()));
+    EXPECT_FALSE(CrashHandler::Register(*registry.front()));
+
+    for(auto& manager : registry) CrashHandler::Unregister(*manager);
+}
+
+TEST(Test_CrashHandler, snapshot_overflow) {
+    char buffer[6];
+    SnapshotWriter writer{buffer, sizeof(buffer)};
+    writer.Write("id ").Write(123456).Write('x');
+    EXPECT_EQ(writer.View(), "id ");
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include    <DatagramSink.h>
+#include    <Manager.h>
+#include    <Factory.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <chrono>
+#include    <fstream>
+#include    <sstream>
+#include    <string>
+#include    <thread>
+
+#include    <fcntl.h>
+#include    <sys/stat.h>
+#include    <sys/wait.h>
+#include    <unistd.h>
+
+namespace {
+    using namespace pentifica::log;
+
+    using RecordEvent = GenericEvent<char const*, int>;
+
+    std::string TempPath(char const* name) {
+        return "/tmp/" + std::string(name) + "_" + std::to_string(::getpid());
+    }
+
+    /// @brief  Start the stand-in collector, writing what it receives to output
+    pid_t StartCollector(std::string const& socket, size_t count, std::string const& output) {
+        auto const child = ::fork();
+        if(child == 0) {
+            auto const fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            ::dup2(fd, STDOUT_FILENO);
+            ::execl(LOG_COLLECTOR, LOG_COLLECTOR, socket.c_str(), std::to_string(count).c_str(), nullptr);
+            ::_exit(127);
+        }
+
+        struct stat status{};
+        for(int attempt = 0; attempt < 200 && ::stat(socket.c_str(), &status) != 0; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return child;
+    }
+}
+
+TEST(Test_DatagramSink, collector) {
+    auto const socket = TempPath("test_datagram_sink.sock");
+    auto const output = TempPath("test_datagram_sink.out");
+    ::unlink(socket.c_str());
+
+    constexpr int count{100};
+
+    DatagramSink sink{socket, 1024 * 1024, 16};
+    std::ostream os{&sink};
+    Manager manager(os, count);
+
+    // No collector yet; records are held for the reconnect
+    for(int i = 0; i < count / 2; ++i) manager.Enqueue(Factory<RecordEvent>::Create("record ", i));
+    manager.Dump();
+    os.flush();
+    EXPECT_FALSE(sink.Connected());
+    EXPECT_EQ(sink.Pending(), count / 2);
+    EXPECT_EQ(sink.Sent(), 0);
+
+    auto const collector = StartCollector(socket, count, output);
+    ASSERT_GT(collector, 0);
+
+    for(int i = count / 2; i < count; ++i) manager.Enqueue(Factory<RecordEvent>::Create("record ", i));
+    manager.Dump();
+    // The collector's receive queue is small; keep flushing as it drains
+    for(int attempt = 0; attempt < 1000 && (os.flush(), sink.Pending() != 0); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(sink.Connected());
+    EXPECT_EQ(sink.Sent(), count);
+    EXPECT_EQ(sink.Pending(), 0);
+    EXPECT_EQ(sink.Dropped(), 0);
+
+    int status{};
+    ASSERT_EQ(::waitpid(collector, &status, 0), collector);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    std::ifstream received{output};
+    std::string line;
+    for(int i = 0; i < count; ++i) {
+        ASSERT_TRUE(std::getline(received, line));
+        EXPECT_NE(line.find("record " + std::to_string(i)), std::string::npos) << line;
+    }
+    EXPECT_FALSE(std::getline(received, line));
+    ::unlink(output.c_str());
+}
+
+TEST(Test_DatagramSink, bounded) {
+    DatagramSink sink{TempPath("test_datagram_sink_absent.sock"), 32, 4, 8};
+    std::ostream os{&sink};
+
+    for(int i = 0; i < 10; ++i) os << "record " << i << '\n';
+    os << "partial";
+    os.flush();
+
+    EXPECT_FALSE(sink.Connected());
+    EXPECT_EQ(sink.Pending(), 4);
+    EXPECT_EQ(sink.Dropped(), 6);
+}
+
+TEST(Test_DatagramSink, oversized) {
+    DatagramSink sink{TempPath("test_datagram_sink_absent.sock"), 64, 8, 16};
+    std::ostream os{&sink};
+
+    os << "short\n" << std::string(17, 'x') << '\n' << std::string(16, 'y') << '\n';
+    os.flush();
+
+    EXPECT_EQ(sink.Pending(), 2);
+    EXPECT_EQ(sink.Dropped(), 1);
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include    <HugePageArena.h>
+#include    <Factory.h>
+#include    <GenericEvent.h>
+#include    <RingBuffer.h>
+
+#include    <gtest/gtest.h>
+
+#include    <cstdint>
+#include    <sstream>
+
+namespace {
+    using namespace pentifica::log;
+
+    struct Element {
+        int id{-1};
+    };
+
+    using ArenaEvent = GenericEvent<char const*, int>;
+    using ArenaFactory = Factory<ArenaEvent, ArenaStorage>;
+}
+
+TEST(Test_HugePageArena, allocate) {
+    HugePageArena arena{1};
+    EXPECT_EQ(arena.Capacity(), HugePageArena::huge_page_size);
+
+    auto first = arena.Allocate(3, 1);
+    auto second = arena.Allocate(64, 64);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second) % 64, 0);
+    EXPECT_TRUE(arena.Owns(first));
+    EXPECT_TRUE(arena.Owns(second));
+    EXPECT_GE(arena.Used(), 67);
+
+    int outside{};
+    EXPECT_FALSE(arena.Owns(&outside));
+
+    EXPECT_EQ(arena.Allocate(HugePageArena::huge_page_size, 1), nullptr);
+}
+
+TEST(Test_HugePageArena, ring_buffer) {
+    HugePageArena arena{1};
+    using ArenaRing = RingBuffer<Element, std::mutex, ArenaAllocator<Element>>;
+
+    constexpr size_t capacity{100};
+    ArenaRing queue{capacity, ArenaAllocator<Element>{arena}};
+    EXPECT_GE(arena.Used(), capacity * sizeof(Element));
+
+    for(int i = 0; i < 150; ++i) queue.Enqueue(Element{i});
+    EXPECT_EQ(queue.Length(), capacity);
+    EXPECT_EQ(queue.Dequeue()->id, 50);
+}
+
+TEST(Test_HugePageArena, resize) {
+    HugePageArena arena{1};
+    using ArenaRing = RingBuffer<Element, std::mutex, ArenaAllocator<Element>>;
+
+    //  Each resize strands the old cache in the arena; once it is exhausted
+    //  the caches come from the heap
+    constexpr size_t capacity{HugePageArena::huge_page_size / sizeof(Element) / 2};
+    ArenaRing queue{capacity, ArenaAllocator<Element>{arena}};
+    for(int i = 0; i < 4; ++i) queue.Enqueue(Element{i});
+    auto const used = arena.Used();
+    EXPECT_GE(used, capacity * sizeof(Element));
+
+    queue.Resize(capacity + 1);
+    EXPECT_EQ(arena.Used(), used);
+    for(size_t i = 0; i < 4; ++i) queue.Resize(capacity - i);
+    EXPECT_LE(arena.Used(), arena.Capacity());
+    EXPECT_EQ(queue.Capacity(), capacity - 3);
+    EXPECT_EQ(queue.Length(), 4);
+    EXPECT_EQ(queue.Dequeue()->id, 0);
+}
+
+TEST(Test_HugePageArena, factory) {
+    ArenaFactory::AddCapacity(10);
+    EXPECT_EQ(ArenaFactory::Available(), 10);
+
+    auto event = ArenaFactory::Create("arena ", 1);
+    EXPECT_TRUE(HugePageArena::Default().Owns(event.get()));
+
+    std::ostringstream oss;
+    oss << *event;
+    EXPECT_NE(oss.str().find("arena 1"), std::string::npos);
+}
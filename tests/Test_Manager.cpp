@@ -1,5 +1,6 @@
 #include <Manager.cpp>
 #include <Factory.h>
+#include <GenericEvent.h>
 
 #include <gtest/gtest.h>
 
@@ -128,4 +129,347 @@ TEST(Test_Manager, clear) {
     manager.Clear();
     manager.Flush(1);
     EXPECT_EQ(manager.Published(), 0);
+}
+
+TEST(Test_Manager, flush_async) {
+    using namespace pentifica::log;
+    using namespace std::chrono_literals;
+
+    std::ostringstream oss;
+
+    Manager manager(oss, capacity);
+
+    for(auto const& message : messages) {
+        manager.Enqueue(CaptureFactory::Create(message));
+    }
+
+    auto task = manager.FlushAsync(messages.size(), 0us);
+    EXPECT_FALSE(task.Done());
+    EXPECT_EQ(manager.Published(), 0);
+
+    size_t slices{};
+    while(task.Resume()) {
+        ++slices;
+        EXPECT_EQ(manager.Published(), slices);
+    }
+    EXPECT_TRUE(task.Done());
+    EXPECT_EQ(task.Published(), messages.size());
+    for(auto const& message : messages) {
+        EXPECT_TRUE(oss.str().find(message) != std::string::npos);
+    }
+}
+
+TEST(Test_Manager, flush_async_scheduler) {
+    using namespace pentifica::log;
+    using namespace std::chrono_literals;
+
+    std::ostringstream oss;
+
+    Manager manager(oss, capacity);
+
+    for(auto const& message : messages) {
+        manager.Enqueue(CaptureFactory::Create(message));
+    }
+
+    std::vector<std::coroutine_handle<>> ready;
+    auto task = manager.FlushAsync(2, 0us, [&ready](std::coroutine_handle<> handle) {
+        ready.push_back(handle);
+    });
+
+    task.Resume();
+    EXPECT_EQ(ready.size(), 1);
+    EXPECT_EQ(manager.Published(), 1);
+
+    auto handle = ready.back();
+    ready.pop_back();
+    handle.resume();
+    EXPECT_TRUE(task.Done());
+    EXPECT_TRUE(ready.empty());
+    EXPECT_EQ(task.Published(), 2);
+
+    manager.Clear();
+}
+
+TEST(Test_Manager, coalesce) {
+    using namespace pentifica::log;
+    using RepeatEvent = GenericEvent<std::string, int>;
+    using RepeatFactory = Factory<RepeatEvent>;
+
+    std::ostringstream oss;
+
+    Manager manager(oss, capacity);
+    manager.SetCoalescing(true);
+
+    manager.Enqueue(RepeatFactory::Create("feed down ", 1));
+    for(size_t i = 0; i < 5; ++i) {
+        manager.Enqueue(RepeatFactory::Create("feed down ", 2));
+    }
+    manager.Enqueue(RepeatFactory::Create("feed up ", 2));
+    manager.Enqueue(RepeatFactory::Create("feed up ", 2));
+
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 8);
+    EXPECT_EQ(manager.Coalesced(), 5);
+
+    auto const text = oss.str();
+    EXPECT_NE(text.find("feed down 1"), std::string::npos);
+    auto const first = text.find("feed down 2");
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_EQ(text.find("feed down 2", first + 1), std::string::npos);
+    EXPECT_NE(text.find("last event repeated 4 times between "), std::string::npos);
+    EXPECT_NE(text.find("last event repeated 1 times between "), std::string::npos);
+}
+
+TEST(Test_Manager, routes) {
+    using namespace pentifica::log;
+    using AuditEvent = GenericEvent<std::string>;
+
+    std::ostringstream bulk;
+    std::ostringstream urgent;
+    std::ostringstream audit;
+
+    Manager manager(bulk, capacity);
+    auto const urgent_route = manager.AddRoute(urgent, RouteFilter{.min_severity_ = Severity::Critical}, capacity);
+    auto const audit_route = manager.AddRoute(audit, RouteFilter{}.Types<AuditEvent>(), 2);
+
+    auto info = CaptureFactory::Create(messages[0]);
+    info->Reset(Severity::Info);
+    manager.Enqueue(std::move(info));
+    auto critical = CaptureFactory::Create(messages[1]);
+    critical->Reset(Severity::Critical);
+    manager.Enqueue(std::move(critical));
+    for(size_t i = 0; i < 3; ++i) {
+        manager.Enqueue(Factory<AuditEvent>::Create("order " + std::to_string(i)));
+    }
+
+    manager.Flush(capacity);
+    EXPECT_NE(bulk.str().find(messages[0]), std::string::npos);
+    EXPECT_EQ(bulk.str().find(messages[1]), std::string::npos);
+    EXPECT_EQ(bulk.str().find("order"), std::string::npos);
+    EXPECT_TRUE(urgent.str().empty());
+    EXPECT_TRUE(audit.str().empty());
+    EXPECT_EQ(manager.Published(), 1);
+
+    manager.DrainRoute(urgent_route, capacity);
+    EXPECT_NE(urgent.str().find(messages[1]), std::string::npos);
+    EXPECT_TRUE(audit.str().empty());
+
+    auto stats = manager.GetRouteStats(audit_route);
+    EXPECT_EQ(stats.routed_, 3);
+    EXPECT_EQ(stats.pending_, 2);
+    EXPECT_EQ(stats.dropped_, 1);
+
+    manager.Dump();
+    EXPECT_EQ(audit.str().find("order 0"), std::string::npos);
+    EXPECT_NE(audit.str().find("order 1"), std::string::npos);
+    EXPECT_NE(audit.str().find("order 2"), std::string::npos);
+    EXPECT_EQ(manager.Published(), 4);
+
+    stats = manager.GetRouteStats(audit_route);
+    EXPECT_EQ(stats.published_, 2);
+    EXPECT_EQ(stats.pending_, 0);
+    EXPECT_EQ(manager.GetRouteStats(urgent_route).published_, 1);
+
+    manager.Enqueue(Factory<AuditEvent>::Create(std::string("order 3")));
+    manager.Flush(capacity);
+    manager.Clear();
+    stats = manager.GetRouteStats(audit_route);
+    EXPECT_EQ(stats.cleared_, 1);
+    EXPECT_EQ(stats.dropped_, 1);
+}
+
+TEST(Test_Manager, flight_recorder) {
+    using namespace pentifica::log;
+    using TickEvent = GenericEvent<char const*, int>;
+
+    std::ostringstream oss;
+
+    Manager manager(oss, capacity);
+    manager.SetFlightRecorder(Severity::Critical, 2, 1);
+
+    auto enqueue = [&manager](int id, Severity severity) {
+        auto event = Factory<TickEvent>::Create("tick ", id);
+        event->Reset(severity);
+        manager.Enqueue(std::move(event));
+    };
+
+    for(int id = 0; id < 5; ++id) enqueue(id, Severity::Debug);
+    manager.Dump();
+    EXPECT_TRUE(oss.str().empty());
+    EXPECT_EQ(manager.Published(), 0);
+
+    enqueue(5, Severity::Critical);
+    EXPECT_EQ(manager.Triggers(), 1);
+    enqueue(6, Severity::Debug);
+    enqueue(7, Severity::Debug);
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 4);
+
+    auto const text = oss.str();
+    EXPECT_EQ(text.find("tick 2"), std::string::npos);
+    EXPECT_NE(text.find("tick 3"), std::string::npos);
+    EXPECT_NE(text.find("tick 4"), std::string::npos);
+    EXPECT_NE(text.find("tick 5"), std::string::npos);
+    EXPECT_NE(text.find("tick 6"), std::string::npos);
+    EXPECT_EQ(text.find("tick 7"), std::string::npos);
+    EXPECT_LT(text.find("tick 3"), text.find("tick 5"));
+
+    //  The trigger is found even when batched
+    std::vector<EventRef> batch;
+    for(int id = 8; id < 12; ++id) {
+        batch.push_back(Factory<TickEvent>::Create("tick ", id));
+        batch.back()->Reset(id == 11 ? Severity::Fatal : Severity::Debug);
+    }
+    manager.EnqueueBatch(batch);
+    EXPECT_EQ(manager.Triggers(), 2);
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 7);
+    EXPECT_NE(oss.str().find("tick 10"), std::string::npos);
+    EXPECT_EQ(oss.str().find("tick 8"), std::string::npos);
+
+    //  Discarded events do not count towards a bounded flush
+    for(int id = 12; id < 21; ++id) enqueue(id, Severity::Debug);
+    enqueue(21, Severity::Critical);
+    manager.Flush(2);
+    EXPECT_EQ(manager.Published(), 11);
+    EXPECT_NE(oss.str().find("tick 12"), std::string::npos);
+    EXPECT_EQ(oss.str().find("tick 18"), std::string::npos);
+    EXPECT_NE(oss.str().find("tick 20"), std::string::npos);
+    EXPECT_NE(oss.str().find("tick 21"), std::string::npos);
+
+    manager.ClearFlightRecorder();
+}
+
+TEST(Test_Manager, parallel_format) {
+    using namespace pentifica::log;
+    using SequenceEvent = GenericEvent<char const*, size_t, char const*>;
+
+    constexpr size_t count{5000};
+
+    std::ostringstream oss;
+
+    Manager manager(oss, count);
+    manager.SetFormatWorkers(3);
+
+    for(size_t i = 0; i < count; ++i) {
+        manager.Enqueue(Factory<SequenceEvent>::Create("seq ", i, ";"));
+    }
+    manager.Flush(count / 2);
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), count);
+
+    auto const text = oss.str();
+    size_t position{};
+    for(size_t i = 0; i < count; ++i) {
+        auto const next = text.find("seq " + std::to_string(i) + ";", position);
+        ASSERT_NE(next, std::string::npos);
+        position = next;
+    }
+
+    manager.SetFormatWorkers(0);
+}
+
+TEST(Test_Manager, memory_budget) {
+    using namespace pentifica::log;
+    using TextEvent = GenericEvent<std::string>;
+
+    constexpr size_t count{10};
+
+    std::ostringstream oss;
+
+    Manager manager(oss, 100);
+    auto const text = [](size_t i) { return std::string(1000, static_cast<char>('a' + i)); };
+    auto const footprint = Factory<TextEvent>::Create(text(0))->Footprint();
+    EXPECT_GT(footprint, text(0).size());
+
+    manager.SetMemoryBudget(footprint * 4);
+    for(size_t i = 0; i < count; ++i) {
+        manager.Enqueue(Factory<TextEvent>::Create(text(i)));
+    }
+    EXPECT_LE(manager.BytesQueued(), footprint * 4);
+    EXPECT_EQ(manager.Dropped(), count - 4);
+
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 4);
+    EXPECT_EQ(manager.BytesQueued(), 0);
+    EXPECT_EQ(oss.str().find(text(count - 5)), std::string::npos);
+    EXPECT_NE(oss.str().find(text(count - 4)), std::string::npos);
+
+    manager.SetMemoryBudget(0);
+    manager.Enqueue(Factory<TextEvent>::Create(text(0)));
+    EXPECT_EQ(manager.BytesQueued(), 0);
+    manager.Clear();
+
+    //  Charged events overwritten after the budget is removed are released
+    Manager small(oss, 4);
+    small.SetMemoryBudget(footprint * 4);
+    for(size_t i = 0; i < 4; ++i) small.Enqueue(Factory<TextEvent>::Create(text(i)));
+    EXPECT_EQ(small.BytesQueued(), footprint * 4);
+    small.SetMemoryBudget(0);
+    for(size_t i = 0; i < 4; ++i) small.Enqueue(Factory<TextEvent>::Create(text(i)));
+    EXPECT_EQ(small.BytesQueued(), 0);
+
+    //  so a new budget starts from the events it charges
+    small.SetMemoryBudget(footprint * 4);
+    for(size_t i = 0; i < 4; ++i) small.Enqueue(Factory<TextEvent>::Create(text(i)));
+    EXPECT_EQ(small.BytesQueued(), footprint * 4);
+    EXPECT_EQ(small.Dropped(), 8);
+    small.Clear();
+}
+
+TEST(Test_Manager, batch) {
+    using namespace pentifica::log;
+
+    std::ostringstream oss;
+
+    Manager manager(oss, capacity);
+
+    {
+        Manager::Batch<3> batch(manager);
+        for(auto const& message : messages) batch.Enqueue(CaptureFactory::Create(message));
+        EXPECT_EQ(manager.Received(), 3);
+        EXPECT_EQ(batch.Size(), 1);
+    }
+    EXPECT_EQ(manager.Received(), messages.size());
+
+    std::vector<EventRef> events;
+    for(auto const& message : messages) events.push_back(CaptureFactory::Create(message));
+    manager.EnqueueBatch(events);
+    EXPECT_EQ(manager.Received(), 2 * messages.size());
+
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 2 * messages.size());
+
+    auto const text = oss.str();
+    size_t position{};
+    for(size_t pass = 0; pass < 2; ++pass) {
+        for(auto const& message : messages) {
+            auto const next = text.find(message, position);
+            ASSERT_NE(next, std::string::npos);
+            position = next;
+        }
+    }
+}
+
+TEST(Test_Manager, resize) {
+    using namespace pentifica::log;
+
+    std::ostringstream oss;
+
+    Manager manager(oss, 2);
+    for(auto const& message : messages) manager.Enqueue(CaptureFactory::Create(message));
+    EXPECT_EQ(manager.Dropped(), messages.size() - 2);
+
+    manager.Resize(capacity);
+    EXPECT_EQ(manager.Capacity(), capacity);
+    for(auto const& message : messages) manager.Enqueue(CaptureFactory::Create(message));
+    EXPECT_EQ(manager.Dropped(), messages.size() - 2);
+
+    manager.Resize(3);
+    EXPECT_EQ(manager.Dropped(), messages.size() - 2 + 3);
+
+    manager.Dump();
+    EXPECT_EQ(manager.Published(), 3);
+    EXPECT_EQ(oss.str().find("line 1"), std::string::npos);
+    EXPECT_LT(oss.str().find("line 2"), oss.str().find("line 4"));
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include    <Metrics.h>
+#include    <Manager.h>
+
+#include    <gtest/gtest.h>
+
+#include    <sstream>
+#include    <string>
+#include    <thread>
+#include    <vector>
+
+namespace {
+    using namespace pentifica::log;
+
+    using FillLatency = MetricEvent<"fill", FieldNames<"venue", "latency_us">, char const*, double>;
+    using OrderCount = MetricEvent<"orders", FieldNames<"side", "quantity">, char const*, int>;
+    using PlainEvent = GenericEvent<char const*, int>;
+}
+
+TEST(Test_Metrics, histogram) {
+    Histogram histogram;
+    for(int i = 1; i <= 100; ++i) histogram.Add(i);
+    histogram.Add(std::numeric_limits<double>::quiet_NaN());
+
+    EXPECT_EQ(histogram.Count(), 100);
+    EXPECT_DOUBLE_EQ(histogram.Mean(), 50.5);
+    EXPECT_DOUBLE_EQ(histogram.Min(), 1);
+    EXPECT_DOUBLE_EQ(histogram.Max(), 100);
+    EXPECT_DOUBLE_EQ(histogram.Percentile(0.5), 64);
+    EXPECT_DOUBLE_EQ(histogram.Percentile(0.99), 100);
+
+    Histogram other;
+    other.Add(0.5);
+    histogram.Merge(other);
+    EXPECT_EQ(histogram.Count(), 101);
+    EXPECT_DOUBLE_EQ(histogram.Min(), 0.5);
+
+    Histogram negative;
+    for(int i = 1; i <= 100; ++i) negative.Add(-i);
+    EXPECT_DOUBLE_EQ(negative.Percentile(0.01), -64);
+    EXPECT_DOUBLE_EQ(negative.Percentile(0.5), -32);
+    EXPECT_DOUBLE_EQ(negative.Percentile(0.99), -2);
+    EXPECT_DOUBLE_EQ(negative.Percentile(1), -1);
+    negative.Add(0.25);
+    EXPECT_DOUBLE_EQ(negative.Percentile(1), 0.25);
+}
+
+TEST(Test_Metrics, stale_cache) {
+    //  A Metrics reusing the address of a destroyed one gets its own shard
+    for(int i = 0; i < 4; ++i) {
+        auto metrics = std::make_unique<Metrics>();
+        std::vector<std::string_view> names{"value"};
+        double const value = 1;
+        metrics->Shard().Fold(typeid(int), "stale", names, std::span<double const>(&value, 1));
+
+        size_t summaries{};
+        metrics->Collect([&summaries](EventRef&& summary) {
+            ++summaries;
+            EXPECT_EQ(static_cast<MetricSummary&>(*summary).Series().count_, 1);
+        });
+        EXPECT_EQ(summaries, 1);
+    }
+}
+
+TEST(Test_Metrics, manager) {
+    std::ostringstream oss;
+
+    Manager manager(oss, 10);
+    manager.SetAggregation(true);
+
+    constexpr size_t threads{4};
+    constexpr int fills{250};
+
+    std::vector<std::thread> producers;
+    for(size_t t = 0; t < threads; ++t) {
+        producers.emplace_back([&manager] {
+            for(int i = 1; i <= fills; ++i) manager.Enqueue(Factory<FillLatency>::Create("XNYS", double(i)));
+        });
+    }
+    for(auto& producer : producers) producer.join();
+    manager.Enqueue(Factory<OrderCount>::Create("buy", 7));
+    manager.Enqueue(Factory<PlainEvent>::Create("plain ", 1));
+
+    EXPECT_EQ(manager.Received(), threads * fills + 2);
+    EXPECT_EQ(manager.Aggregated(), threads * fills + 1);
+
+    manager.Flush(10);
+    EXPECT_EQ(manager.Published(), 3);
+
+    auto const text = oss.str();
+    EXPECT_NE(text.find("plain 1"), std::string::npos);
+    EXPECT_NE(text.find("metrics fill count=1000"), std::string::npos) << text;
+    EXPECT_NE(text.find("latency_us{mean=125.5 min=1 p50=128 p99=250 max=250}"), std::string::npos) << text;
+    EXPECT_NE(text.find("metrics orders count=1"), std::string::npos) << text;
+    EXPECT_EQ(text.find("venue{"), std::string::npos);
+
+    // Nothing aggregated since the last flush
+    oss.str("");
+    manager.Flush(10);
+    EXPECT_TRUE(oss.str().empty());
+
+    manager.SetAggregation(false);
+    manager.Enqueue(Factory<FillLatency>::Create("XNYS", 1.5));
+    manager.Dump();
+    EXPECT_NE(oss.str().find("venue=XNYS latency_us=1.5"), std::string::npos) << oss.str();
+}
+
+TEST(Test_Metrics, json) {
+    std::ostringstream oss;
+
+    Manager manager(oss, 10);
+    manager.SetAggregation(true);
+    manager.SetFormat(Manager::Format::JsonLines);
+    manager.Enqueue(Factory<OrderCount>::Create("sell", 4));
+    manager.Dump();
+
+    EXPECT_NE(oss.str().find("\"metric\":\"orders\",\"count\":1,"), std::string::npos) << oss.str();
+    EXPECT_NE(oss.str().find("\"quantity\":{\"mean\":4,\"min\":4,\"p50\":4,\"p99\":4,\"max\":4}"), std::string::npos) << oss.str();
+}
+
+TEST(Test_Metrics, lazy_shards) {
+    Metrics metrics;
+
+    // Events without metrics do not look up a shard
+    EXPECT_FALSE(Factory<PlainEvent>::Create("plain ", 1)->Fold(metrics));
+    EXPECT_EQ(metrics.ShardCount(), 0);
+
+    std::vector<std::thread> producers;
+    for(int t = 0; t < 4; ++t) {
+        producers.emplace_back([&metrics] { EXPECT_TRUE(Factory<OrderCount>::Create("buy", 7)->Fold(metrics)); });
+    }
+    for(auto& producer : producers) producer.join();
+    EXPECT_EQ(metrics.ShardCount(), 4);
+
+    // The shards of exited threads are dropped once collected
+    size_t count{};
+    metrics.Collect([&count](EventRef&& summary) { count += static_cast<MetricSummary&>(*summary).Series().count_; });
+    EXPECT_EQ(count, 4);
+    EXPECT_EQ(metrics.ShardCount(), 0);
+}
\ No newline at end of file
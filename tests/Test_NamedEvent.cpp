@@ -0,0 +1,67 @@
+#include    <NamedEvent.h>
+#include    <Manager.h>
+
+#include    <gtest/gtest.h>
+
+#include    <limits>
+#include    <sstream>
+#include    <string>
+
+namespace {
+    using namespace pentifica::log;
+
+    using FillEvent = NamedEvent<FieldNames<"symbol", "price", "quantity", "buy">,
+                                 std::string, double, int, bool>;
+
+    struct Plain final : public Event {
+        using Event::Event;
+        void Log(std::ostream& os) const override { os << "say \"hi\"\n\tback\\slash"; }
+    };
+}
+
+TEST(Test_NamedEvent, text) {
+    FillEvent event{"ABC", 101.25, 300, true};
+    std::ostringstream oss;
+    oss << event;
+    EXPECT_NE(oss.str().find("symbol=ABC price=101.25 quantity=300 buy=1"), std::string::npos);
+}
+
+TEST(Test_NamedEvent, json) {
+    FillEvent event{"A\"B", 101.25, -3, false};
+    event.Reset(Severity::Info);
+    std::ostringstream oss;
+    oss << AsJson{event};
+
+    auto const text = oss.str();
+    EXPECT_EQ(text.find("{\"time\":\""), 0);
+    EXPECT_NE(text.find("\"severity\":\"Info\","), std::string::npos);
+    EXPECT_NE(text.find(",\"symbol\":\"A\\\"B\",\"price\":101.25,\"quantity\":-3,\"buy\":false}\n"),
+              std::string::npos);
+}
+
+TEST(Test_NamedEvent, json_non_finite) {
+    using RatioEvent = NamedEvent<FieldNames<"ratio">, double>;
+    RatioEvent event{std::numeric_limits<double>::infinity()};
+    std::ostringstream oss;
+    oss << AsJson{event};
+    EXPECT_NE(oss.str().find("\"ratio\":null}"), std::string::npos);
+}
+
+TEST(Test_NamedEvent, json_message) {
+    Plain event{Severity::Alert};
+    std::ostringstream oss;
+    oss << AsJson{event};
+    EXPECT_NE(oss.str().find("\"severity\":\"Alert\",\"message\":\"say \\\"hi\\\"\\n\\tback\\\\slash\"}\n"),
+              std::string::npos);
+}
+
+TEST(Test_NamedEvent, manager) {
+    std::ostringstream oss;
+    Manager manager(oss, 10);
+    manager.SetFormat(Manager::Format::JsonLines);
+
+    manager.Enqueue(Factory<FillEvent>::Create("XYZ", 9.5, 10, true));
+    manager.Dump();
+    EXPECT_NE(oss.str().find(",\"symbol\":\"XYZ\",\"price\":9.5,\"quantity\":10,\"buy\":true}\n"),
+              std::string::npos);
+}
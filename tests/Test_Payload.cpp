@@ -0,0 +1,92 @@
+#include    <Payload.h>
+#include    <GenericEvent.h>
+#include    <Manager.h>
+#include    <SizeClassPool.h>
+
+#include    <gtest/gtest.h>
+
+#include    <limits>
+#include    <sstream>
+
+namespace {
+    using namespace pentifica::log;
+
+    Payload::Buffer MakeBuffer(size_t size) {
+        auto buffer = std::make_shared<std::byte[]>(size);
+        for(size_t i = 0; i < size; ++i) buffer[i] = static_cast<std::byte>('A' + i % 26);
+        return buffer;
+    }
+
+    using PacketEvent = GenericEvent<char const*, Payload>;
+}
+
+TEST(Test_Payload, render) {
+    Payload::SetRenderLimit(20);
+
+    Payload payload{MakeBuffer(40), 40};
+    std::ostringstream oss;
+    oss << payload;
+    auto const text = oss.str();
+    EXPECT_NE(text.find("payload(40 bytes)"), std::string::npos);
+    EXPECT_NE(text.find("0000  41 42 43 44 45 46 47 48 49 4a 4b 4c 4d 4e 4f 50  ABCDEFGHIJKLMNOP"), std::string::npos);
+    EXPECT_NE(text.find("0010  51 52 53 54"), std::string::npos);
+    EXPECT_NE(text.find("20 bytes not shown"), std::string::npos);
+
+    Payload::SetRenderLimit(256);
+}
+
+TEST(Test_Payload, budget) {
+    auto const in_use = Payload::InUse();
+    Payload::SetBudget(in_use + 100);
+    {
+        Payload kept{MakeBuffer(60), 60};
+        EXPECT_FALSE(kept.Dropped());
+        EXPECT_EQ(Payload::InUse(), in_use + 60);
+
+        Payload dropped{MakeBuffer(60), 60};
+        EXPECT_TRUE(dropped.Dropped());
+        EXPECT_EQ(dropped.Size(), 60);
+        EXPECT_TRUE(dropped.Bytes().empty());
+        EXPECT_EQ(Payload::InUse(), in_use + 60);
+
+        std::ostringstream oss;
+        oss << dropped;
+        EXPECT_NE(oss.str().find("dropped"), std::string::npos);
+    }
+    EXPECT_EQ(Payload::InUse(), in_use);
+    Payload::SetBudget(std::numeric_limits<size_t>::max());
+}
+
+TEST(Test_Payload, pooled_lease) {
+    auto const buffer = MakeBuffer(16);
+    auto& pool = SizeClassPool::Default();
+    auto const available = [&pool] {
+        size_t total{};
+        for(auto size = SizeClassPool::min_block; size <= SizeClassPool::max_block; size *= 2) total += pool.Available(size);
+        return total;
+    };
+    for(auto size = SizeClassPool::min_block; size <= SizeClassPool::max_block; size *= 2) pool.Reserve(size, 1);
+    auto const before = available();
+    {
+        Payload payload{buffer, 16};
+        Payload copy{payload};
+        EXPECT_EQ(available(), before - 1);
+    }
+    EXPECT_EQ(available(), before);
+}
+
+TEST(Test_Payload, released_after_flush) {
+    auto const buffer = MakeBuffer(1024);
+    auto const in_use = Payload::InUse();
+
+    std::ostringstream oss;
+    Manager manager(oss, 4);
+    manager.Enqueue(Factory<PacketEvent>::Create("packet ", Payload{buffer, 1024}));
+    EXPECT_EQ(Payload::InUse(), in_use + 1024);
+    EXPECT_EQ(buffer.use_count(), 2);
+
+    manager.Dump();
+    EXPECT_EQ(Payload::InUse(), in_use);
+    EXPECT_EQ(buffer.use_count(), 1);
+    EXPECT_NE(oss.str().find("packet payload(1024 bytes)"), std::string::npos);
+}
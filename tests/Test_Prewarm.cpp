@@ -0,0 +1,42 @@
+#include    <Prewarm.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <sstream>
+
+namespace {
+    using namespace pentifica::log;
+
+    using OpenEvent = GenericEvent<char const*, long, double>;
+    using CloseEvent = GenericEvent<char const*, long>;
+
+    PrewarmCapacity<OpenEvent> const open_prewarm{64};
+    PrewarmCapacity<CloseEvent> const close_prewarm{32};
+}
+
+TEST(Test_Prewarm, registry) {
+    EXPECT_TRUE(Prewarm());
+    EXPECT_GE(Factory<OpenEvent>::Capacity(), 64);
+    EXPECT_GE(Factory<OpenEvent>::Available(), 64);
+    EXPECT_GE(Factory<CloseEvent>::Capacity(), 32);
+
+    auto const capacity = Factory<OpenEvent>::Capacity();
+    {
+        auto event = Factory<OpenEvent>::Create("open ", 1L, 2.5);
+        EXPECT_EQ(Factory<OpenEvent>::Capacity(), capacity);
+    }
+
+    EXPECT_TRUE(Prewarm());
+    EXPECT_EQ(Factory<OpenEvent>::Capacity(), capacity);
+}
+
+TEST(Test_Prewarm, manager) {
+    std::ostringstream oss;
+    Manager manager(oss, 128);
+
+    Prewarm(manager, true);
+    manager.Enqueue(Factory<CloseEvent>::Create("close ", 7L));
+    manager.Dump();
+    EXPECT_NE(oss.str().find("close 7"), std::string::npos);
+}
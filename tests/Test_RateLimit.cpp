@@ -0,0 +1,68 @@
+#include    <RateLimit.h>
+
+#include    <gtest/gtest.h>
+
+#include    <sstream>
+
+namespace {
+    using namespace pentifica::log;
+    using namespace std::chrono_literals;
+
+    using FeedEvent = GenericEvent<char const*, int>;
+}
+
+TEST(Test_RateLimit, token_bucket) {
+    TokenBucket bucket{10, 5};
+    auto const now = TokenBucket::Clock::now();
+
+    for(int i = 0; i < 5; ++i) EXPECT_TRUE(bucket.TryAcquire(now));
+    EXPECT_FALSE(bucket.TryAcquire(now));
+
+    EXPECT_FALSE(bucket.TryAcquire(now + 50ms));
+    EXPECT_TRUE(bucket.TryAcquire(now + 100ms));
+    EXPECT_FALSE(bucket.TryAcquire(now + 100ms));
+}
+
+TEST(Test_RateLimit, unlimited) {
+    TokenBucket bucket{0, 1};
+    for(int i = 0; i < 1000; ++i) EXPECT_TRUE(bucket.TryAcquire());
+}
+
+TEST(Test_RateLimit, sampling) {
+    CallSite site{"sampled", {.sample_ = 4}};
+
+    size_t admitted{};
+    for(int i = 0; i < 100; ++i) admitted += site.Admit();
+    EXPECT_EQ(admitted, 25);
+    EXPECT_EQ(site.Suppressed(), 75);
+}
+
+TEST(Test_RateLimit, summary) {
+    std::ostringstream oss;
+    Manager manager(oss, 100);
+
+    CallSite site{"feed", {.rate_ = 1, .burst_ = 2, .summary_interval_ = 1h}};
+    size_t enqueued{};
+    for(int i = 0; i < 50; ++i) {
+        enqueued += site.Emit<FeedEvent>(manager, Severity::Alert, "bad tick ", i);
+    }
+    EXPECT_EQ(enqueued, 2);
+    //  The window opened with the first suppressed event and is still open
+    EXPECT_EQ(site.Summaries(), 0);
+    EXPECT_EQ(site.Suppressed(), 48);
+
+    auto const now = CallSite::Clock::now();
+    site.Summarize(manager, Severity::Alert, now + 30min);
+    EXPECT_EQ(site.Summaries(), 0);
+    site.Summarize(manager, Severity::Alert, now + 1h);
+    EXPECT_EQ(site.Summaries(), 1);
+    EXPECT_EQ(site.Suppressed(), 0);
+
+    manager.Dump();
+    auto const text = oss.str();
+    EXPECT_NE(text.find("bad tick 0"), std::string::npos);
+    EXPECT_NE(text.find("bad tick 1"), std::string::npos);
+    EXPECT_EQ(text.find("bad tick 2"), std::string::npos);
+    EXPECT_NE(text.find("call site feed: 48 events suppressed"), std::string::npos);
+    EXPECT_NE(text.find(ToString(Severity::Alert)), std::string::npos);
+}
@@ -119,4 +119,85 @@ TEST(Test_RingBuffer, unique) {
     using namespace pentifica::log;
 
     constexpr size_t capacity = 20;
+}
+
+TEST(Test_RingBuffer, batch) {
+    using namespace pentifica::log;
+
+    constexpr size_t capacity{20};
+    constexpr size_t overrun{5};
+
+    RingBuffer<Element> queue(capacity);
+
+    std::vector<Element> batch;
+    for(size_t i = 0; i < capacity + overrun; ++i) batch.push_back(Element{static_cast<int>(i)});
+
+    queue.EnqueueBatch(batch.begin(), batch.begin() + overrun);
+    EXPECT_EQ(queue.Length(), overrun);
+    EXPECT_EQ(queue.Overruns(), 0);
+
+    queue.EnqueueBatch(batch.begin() + overrun, batch.end());
+    EXPECT_EQ(queue.Length(), capacity);
+    EXPECT_EQ(queue.Overruns(), overrun);
+
+    for(size_t i = overrun; i < capacity + overrun; ++i) {
+        auto result = queue.Dequeue();
+        EXPECT_EQ(result->id, static_cast<int>(i));
+    }
+
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(Test_RingBuffer, resize) {
+    using namespace pentifica::log;
+
+    constexpr size_t capacity{8};
+
+    RingBuffer<Element> queue(capacity);
+
+    // Wrap the ring so the pending events straddle the end of the cache
+    for(int i = 0; i < 6; ++i) queue.Enqueue(Element{i});
+    for(int i = 0; i < 4; ++i) queue.Dequeue();
+    for(int i = 6; i < 12; ++i) queue.Enqueue(Element{i});
+    EXPECT_EQ(queue.Length(), 8);
+
+    queue.Resize(16);
+    EXPECT_EQ(queue.Capacity(), 16);
+    EXPECT_EQ(queue.Length(), 8);
+    for(int i = 12; i < 20; ++i) queue.Enqueue(Element{i});
+    EXPECT_EQ(queue.Overruns(), 0);
+
+    std::vector<int> dropped;
+    queue.Resize(5, [&dropped](Element&& element) { dropped.push_back(element.id); });
+    EXPECT_EQ(queue.Capacity(), 5);
+    EXPECT_EQ(queue.Overruns(), 11);
+    EXPECT_EQ(dropped.size(), 11);
+    EXPECT_EQ(dropped.front(), 4);
+
+    for(int i = 15; i < 20; ++i) EXPECT_EQ(queue.Dequeue()->id, i);
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(Test_RingBuffer, move) {
+    using namespace pentifica::log;
+
+    RingBuffer<Element> queue(4);
+    for(int i = 0; i < 6; ++i) queue.Enqueue(Element{i});
+
+    RingBuffer<Element> moved(std::move(queue));
+    EXPECT_EQ(moved.Capacity(), 4);
+    EXPECT_EQ(moved.Overruns(), 2);
+    EXPECT_EQ(queue.Length(), 0);
+
+    RingBuffer<Element> assigned(1);
+    assigned = std::move(moved);
+    for(int i = 2; i < 6; ++i) EXPECT_EQ(assigned.Dequeue()->id, i);
+
+    //  Moved from buffers remain usable
+    EXPECT_EQ(queue.Capacity(), 4);
+    queue.Enqueue(Element{7});
+    EXPECT_EQ(queue.Dequeue()->id, 7);
+    EXPECT_EQ(moved.Capacity(), 4);
+    moved.Enqueue(Element{8});
+    EXPECT_EQ(moved.Dequeue()->id, 8);
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include    <SizeClassPool.h>
+#include    <Factory.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <cstdint>
+#include    <sstream>
+#include    <string>
+#include    <vector>
+
+namespace {
+    using namespace pentifica::log;
+
+    using SmallEvent = GenericEvent<char const*, int>;
+    using OtherEvent = GenericEvent<char const*, long>;
+    using SmallFactory = Factory<SmallEvent, SizeClassStorage>;
+    using OtherFactory = Factory<OtherEvent, SizeClassStorage>;
+}
+
+TEST(Test_SizeClassPool, classes) {
+    EXPECT_EQ(SizeClassPool::BlockSize(1), 64);
+    EXPECT_EQ(SizeClassPool::BlockSize(64), 64);
+    EXPECT_EQ(SizeClassPool::BlockSize(65), 128);
+    EXPECT_EQ(SizeClassPool::BlockSize(256), 256);
+    EXPECT_EQ(SizeClassPool::BlockSize(2048), 2048);
+    EXPECT_TRUE(SizeClassPool::Serves(2048, 8));
+    EXPECT_FALSE(SizeClassPool::Serves(2049, 8));
+    EXPECT_FALSE(SizeClassPool::Serves(64, 128));
+}
+
+TEST(Test_SizeClassPool, allocate) {
+    SizeClassPool pool;
+    EXPECT_EQ(pool.Capacity(100), 0);
+
+    auto first = pool.Allocate(100);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % SizeClassPool::min_block, 0);
+    EXPECT_EQ(pool.Capacity(100), SizeClassPool::slab_size / 128);
+    EXPECT_EQ(pool.Available(128), pool.Capacity(128) - 1);
+    EXPECT_EQ(pool.Capacity(64), 0);
+
+    pool.Deallocate(first, 100);
+    EXPECT_EQ(pool.Available(100), pool.Capacity(100));
+    EXPECT_EQ(pool.Allocate(120), first);
+    pool.Deallocate(first, 120);
+
+    EXPECT_TRUE(pool.Reserve(2048, 100));
+    EXPECT_GE(pool.Available(2048), 100);
+}
+
+TEST(Test_SizeClassPool, factory) {
+    static_assert(SharedStorage<SizeClassStorage>);
+    static_assert(!SharedStorage<HeapStorage>);
+    ASSERT_EQ(SizeClassPool::BlockSize(sizeof(SmallEvent)), SizeClassPool::BlockSize(sizeof(OtherEvent)));
+
+    SmallFactory::AddCapacity(10);
+    EXPECT_GE(SmallFactory::Available(), 10);
+
+    void* released{};
+    {
+        auto event = SmallFactory::Create("small ", 1);
+        released = event.get();
+        std::ostringstream oss;
+        oss << *event;
+        EXPECT_NE(oss.str().find("small 1"), std::string::npos);
+    }
+
+    // A block released by one product type is reused by another
+    auto const available = OtherFactory::Available();
+    auto other = OtherFactory::Create("other ", 2L);
+    EXPECT_EQ(static_cast<void*>(other.get()), released);
+    EXPECT_EQ(OtherFactory::Available(), available - 1);
+    EXPECT_EQ(SmallFactory::Available(), available - 1);
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include    <SpillSink.h>
+#include    <Manager.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <chrono>
+#include    <cstdint>
+#include    <cstring>
+#include    <fstream>
+#include    <iterator>
+#include    <sstream>
+#include    <string>
+#include    <thread>
+
+#include    <unistd.h>
+
+namespace {
+    using namespace pentifica::log;
+    using namespace std::chrono_literals;
+
+    /// @brief  A sink that stalls every write while stalled_ is set
+    class StallingSink :
+        public std::streambuf
+    {
+    public:
+        bool stalled_{false};
+        /// @brief  Take nothing while set
+        bool failed_{false};
+        std::string text_{};
+
+    protected:
+        int_type overflow(int_type c) override {
+            if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+            char const character = traits_type::to_char_type(c);
+            xsputn(&character, 1);
+            return c;
+        }
+        std::streamsize xsputn(char const* text, std::streamsize count) override {
+            if(failed_) return 0;
+            if(stalled_) std::this_thread::sleep_for(20ms);
+            text_.append(text, static_cast<size_t>(count));
+            return count;
+        }
+    };
+
+    std::string SpillPath() {
+        return "/tmp/test_spill_sink_" + std::to_string(::getpid());
+    }
+
+    void ExpectInOrder(std::string const& text, int count) {
+        size_t position{};
+        for(int i = 0; i < count; ++i) {
+            auto const next = text.find("line " + std::to_string(i) + "\n", position);
+            ASSERT_NE(next, std::string::npos) << i;
+            position = next;
+        }
+    }
+}
+
+TEST(Test_SpillSink, spill_and_replay) {
+    StallingSink sink;
+    SpillSink spill{sink, SpillPath(), 5ms, 50ms};
+    std::ostream os{&spill};
+
+    for(int i = 0; i < 5; ++i) os << "line " << i << '\n';
+    EXPECT_FALSE(spill.Spilling());
+
+    sink.stalled_ = true;
+    for(int i = 5; i < 10; ++i) os << "line " << i << '\n';
+    os.flush();
+    EXPECT_TRUE(spill.Spilling());
+    EXPECT_EQ(spill.Stalls(), 1);
+    EXPECT_EQ(spill.Spilled(), 4);
+    EXPECT_EQ(sink.text_.find("line 6"), std::string::npos);
+
+    sink.stalled_ = false;
+    std::this_thread::sleep_for(60ms);
+    os << "line 10\n";
+    EXPECT_FALSE(spill.Spilling());
+    EXPECT_EQ(spill.Replayed(), 4);
+    ExpectInOrder(sink.text_, 11);
+}
+
+TEST(Test_SpillSink, manager) {
+    StallingSink sink;
+    constexpr int count{100};
+    {
+        SpillSink spill{sink, SpillPath(), 5ms, 1h};
+        std::ostream os{&spill};
+
+        using LineEvent = GenericEvent<char const*, int>;
+        Manager manager(os, count);
+        sink.stalled_ = true;
+        for(int i = 0; i < count; ++i) manager.Enqueue(Factory<LineEvent>::Create("line ", i));
+
+        auto const start = std::chrono::steady_clock::now();
+        manager.Dump();
+        EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+        EXPECT_EQ(manager.Dropped(), 0);
+        EXPECT_EQ(spill.Spilled(), count - 1);
+
+        // Spilled lines are replayed when the SpillSink is destroyed
+        sink.stalled_ = false;
+    }
+    ExpectInOrder(sink.text_, count);
+    EXPECT_NE(::access(SpillPath().c_str(), F_OK), 0);
+}
+
+TEST(Test_SpillSink, failed_sink) {
+    StallingSink sink;
+    {
+        SpillSink spill{sink, SpillPath(), 5ms, 1h};
+        std::ostream os{&spill};
+
+        sink.stalled_ = true;
+        for(int i = 0; i < 3; ++i) os << "line " << i << '\n';
+        EXPECT_EQ(spill.Spilled(), 2);
+        EXPECT_EQ(spill.Dropped(), 0);
+
+        // The sink fails the final replay, so the spill file is kept
+        sink.failed_ = true;
+    }
+    std::ifstream file{SpillPath(), std::ios::binary};
+    ASSERT_TRUE(file.is_open());
+    std::string const records{std::istreambuf_iterator<char>(file), {}};
+    std::uint32_t length{};
+    ASSERT_GE(records.size(), sizeof(length));
+    std::memcpy(&length, records.data(), sizeof(length));
+    EXPECT_EQ(records.substr(sizeof(length), length), "line 1\n");
+    EXPECT_NE(records.find("line 2\n"), std::string::npos);
+    ::unlink(SpillPath().c_str());
+}
\ No newline at end of file
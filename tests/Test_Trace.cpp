@@ -0,0 +1,105 @@
+#include    <Trace.h>
+#include    <Manager.h>
+#include    <GenericEvent.h>
+
+#include    <gtest/gtest.h>
+
+#include    <sstream>
+#include    <stdexcept>
+#include    <string>
+
+#include    <unistd.h>
+
+namespace {
+    using namespace pentifica::log;
+
+    using OrderEvent = GenericEvent<char const*, int, char const*, double, char, bool>;
+    using TextEvent = GenericEvent<std::string, unsigned>;
+
+    std::string TracePath() {
+        return "/tmp/test_trace_" + std::to_string(::getpid());
+    }
+}
+
+TEST(Test_Trace, record_and_read) {
+    auto const path = TracePath();
+    std::ostringstream oss;
+    {
+        TraceRecorder trace{path};
+        Manager manager(oss, 10);
+        manager.SetTrace(&trace);
+
+        auto event = Factory<OrderEvent>::Create("order ", 7, " price ", 10.25, 'B', true);
+        event->Reset(Severity::Critical);
+        manager.Enqueue(std::move(event));
+        manager.Enqueue(Factory<TextEvent>::Create(std::string("text "), 3u));
+        manager.Enqueue(Factory<OrderEvent>::Create("order ", 8, " price ", 11.5, 'S', false));
+        manager.SetTrace(nullptr);
+        manager.Enqueue(Factory<TextEvent>::Create(std::string("untraced "), 4u));
+        EXPECT_EQ(trace.Recorded(), 3);
+        manager.Dump();
+        trace.Flush();
+        EXPECT_EQ(trace.Lost(), 0);
+    }
+
+    TraceReader reader{path};
+    TraceRecord record;
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(reader.TypeName(record.type_), typeid(OrderEvent).name());
+    EXPECT_EQ(record.severity_, Severity::Critical);
+    ASSERT_EQ(record.fields_.size(), 6);
+    EXPECT_EQ(std::get<std::string>(record.fields_[0]), "order ");
+    EXPECT_EQ(std::get<std::int64_t>(record.fields_[1]), 7);
+    EXPECT_EQ(std::get<double>(record.fields_[3]), 10.25);
+    EXPECT_EQ(std::get<char>(record.fields_[4]), 'B');
+    EXPECT_EQ(std::get<bool>(record.fields_[5]), true);
+    auto const order_type = record.type_;
+
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(reader.TypeName(record.type_), typeid(TextEvent).name());
+    EXPECT_EQ(std::get<std::uint64_t>(record.fields_[1]), 3);
+
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(record.type_, order_type);
+    EXPECT_FALSE(reader.Next(record));
+
+    ::unlink(path.c_str());
+}
+
+TEST(Test_Trace, replay) {
+    auto const path = TracePath();
+    constexpr int count{500};
+
+    std::ostringstream original;
+    {
+        TraceRecorder trace{path};
+        Manager manager(original, count);
+        manager.SetTrace(&trace);
+        for(int i = 0; i < count; ++i) {
+            manager.Enqueue(Factory<OrderEvent>::Create("order ", i, " price ", i * 0.5, 'B', i % 2 == 0));
+        }
+        manager.Dump();
+    }
+
+    std::ostringstream replayed;
+    TraceReader reader{path};
+    Manager manager(replayed, count);
+    auto const report = Replay(reader, manager, ReplayOptions{0, 64});
+
+    EXPECT_EQ(report.events_, count);
+    EXPECT_EQ(report.dropped_, 0);
+    EXPECT_GT(report.Throughput(), 0);
+    EXPECT_LE(report.p50_, report.p99_);
+    EXPECT_LE(report.p99_, report.max_);
+    EXPECT_EQ(replayed.str(), original.str());
+    EXPECT_GT(Factory<PooledReplayEvent<0>>::Capacity(), 0);
+    EXPECT_EQ(Factory<PooledReplayEvent<1>>::Capacity(), 0);
+
+    // Latency cannot be attributed when events are not written one for one
+    Manager coalescing(replayed, count);
+    coalescing.SetCoalescing(true);
+    TraceReader again{path};
+    EXPECT_THROW(Replay(again, coalescing), std::invalid_argument);
+
+    ::unlink(path.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include    <Utility.h>
+
+#include    <gtest/gtest.h>
+
+#include    <iomanip>
+#include    <limits>
+#include    <sstream>
+#include    <string>
+
+namespace {
+    struct Custom {
+        int value_;
+        friend std::ostream& operator<<(std::ostream& os, Custom const& custom) {
+            return os << '<' << custom.value_ << '>';
+        }
+    };
+
+    template<typename... Ts>
+    std::string Streamed(Ts const&... values) {
+        std::ostringstream oss;
+        (oss << ... << values);
+        return oss.str();
+    }
+
+    template<typename... Ts>
+    std::string Written(Ts const&... values) {
+        std::ostringstream oss;
+        {
+            pentifica::log::FieldWriter writer{oss};
+            (writer.Write(values), ...);
+        }
+        return oss.str();
+    }
+}
+
+TEST(Test_Utility, matches_stream) {
+    EXPECT_EQ(Written(0, -1, 42u, std::numeric_limits<long long>::min()),
+              Streamed(0, -1, 42u, std::numeric_limits<long long>::min()));
+    EXPECT_EQ(Written(34.9, 1.0 / 3, 1e20, -0.0, 2.5f), Streamed(34.9, 1.0 / 3, 1e20, -0.0, 2.5f));
+    EXPECT_EQ(Written(true, false, 'x'), Streamed(true, false, 'x'));
+    EXPECT_EQ(Written("text ", std::string{"string "}, std::string_view{"view"}),
+              Streamed("text ", std::string{"string "}, std::string_view{"view"}));
+    EXPECT_EQ(Written("custom=", Custom{7}, ';'), Streamed("custom=", Custom{7}, ';'));
+}
+
+TEST(Test_Utility, long_text) {
+    std::string const text(1000, 'a');
+    EXPECT_EQ(Written(1, text, 2), Streamed(1, text, 2));
+}
+
+TEST(Test_Utility, stream_state) {
+    std::ostringstream oss;
+    oss << std::hex << std::boolalpha;
+    {
+        pentifica::log::FieldWriter writer{oss};
+        writer.Write(255).Write(' ').Write(true);
+    }
+    EXPECT_EQ(oss.str(), "ff true");
+}
+
+TEST(Test_Utility, hex) {
+    std::ostringstream oss;
+    {
+        pentifica::log::FieldWriter writer{oss};
+        writer.WriteHex(0xdeadbeef, 8).Write(' ').WriteHex(0xabc, 3).Write(' ').WriteHex(1);
+    }
+    EXPECT_EQ(oss.str(), "deadbeef abc 0000000000000001");
+}
+
+TEST(Test_Utility, tuple) {
+    using namespace pentifica::log;
+
+    std::ostringstream oss;
+    oss << std::make_tuple("price=", 101.25, ", qty=", 300, ", id=", Custom{9});
+    EXPECT_EQ(oss.str(), "price=101.25, qty=300, id=<9>");
+}
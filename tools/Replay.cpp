@@ -0,0 +1,102 @@
+/// @copyright {2023, Russell J. Fleming. All rights reserved.}
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+
+/// @brief  Replays a trace recorded with Manager::SetTrace through a Manager
+///         configured from the command line, reporting throughput and the
+///         latency from enqueue to write.
+///             log_replay <trace> [--speed <factor>] [--output <file>]
+///                        [--json] [--workers <count>] [--capacity <events>]
+///                        [--flush <events>]
+///         --speed 0 (the default) replays as fast as possible, 1 at the
+///         recorded rate. Output is discarded unless --output is given.
+#include <Manager.h>
+#include <Trace.h>
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+    int Usage(char const* program) {
+        std::cerr << "usage: " << program << " <trace> [--speed <factor>] [--output <file>] [--json]"
+                     " [--workers <count>] [--capacity <events>] [--flush <events>]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    using namespace pentifica::log;
+
+    if(argc < 2) return Usage(argv[0]);
+
+    std::string trace{argv[1]};
+    std::string output{"/dev/null"};
+    ReplayOptions options;
+    bool json{};
+    size_t workers{};
+    size_t capacity{64 * 1024};
+
+    for(int i = 2; i < argc; ++i) {
+        std::string_view const option{argv[i]};
+        auto value = [&]() -> char const* { return i + 1 < argc ? argv[++i] : nullptr; };
+        if(option == "--json") json = true;
+        else if(option == "--speed") { auto v = value(); if(!v) return Usage(argv[0]); options.speed_ = std::atof(v); }
+        else if(option == "--output") { auto v = value(); if(!v) return Usage(argv[0]); output = v; }
+        else if(option == "--workers") { auto v = value(); if(!v) return Usage(argv[0]); workers = std::strtoul(v, nullptr, 10); }
+        else if(option == "--capacity") { auto v = value(); if(!v) return Usage(argv[0]); capacity = std::strtoul(v, nullptr, 10); }
+        else if(option == "--flush") { auto v = value(); if(!v) return Usage(argv[0]); options.flush_every_ = std::strtoul(v, nullptr, 10); }
+        else return Usage(argv[0]);
+    }
+
+    try {
+        TraceReader reader{trace};
+        std::ofstream os{output, std::ios::binary};
+        if(!os) {
+            std::cerr << "cannot open " << output << '\n';
+            return 1;
+        }
+
+        Manager manager{os, capacity};
+        if(json) manager.SetFormat(Manager::Format::JsonLines);
+        if(workers) manager.SetFormatWorkers(workers);
+
+        auto const report = Replay(reader, manager, options);
+        auto const micros = [](std::chrono::nanoseconds latency) {
+            return std::chrono::duration<double, std::micro>(latency).count();
+        };
+        std::cout << "events      " << report.events_ << '\n'
+                  << "dropped     " << report.dropped_ << '\n'
+                  << "elapsed     " << std::chrono::duration<double>(report.elapsed_).count() << " s\n"
+                  << "throughput  " << report.Throughput() << " events/s\n"
+                  << "latency us  p50 " << micros(report.p50_)
+                  << "  p90 " << micros(report.p90_)
+                  << "  p99 " << micros(report.p99_)
+                  << "  p99.9 " << micros(report.p999_)
+                  << "  max " << micros(report.max_) << '\n';
+    }
+    catch(std::exception const& error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file